@@ -0,0 +1,400 @@
+#include "pseudosem.h"
+#include "pseudosem/sort.h"
+#include "pseudosem/table.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+// Count allocations, so that allocations per operation can be reported.
+namespace {
+    std::atomic<size_t> allocationCount(0);
+}
+
+void* operator new(size_t size) {
+    ++allocationCount;
+    if (void* pointer = std::malloc(size == 0 ? 1 : size))
+        return pointer;
+
+    throw std::bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    ++allocationCount;
+    return std::malloc(size == 0 ? 1 : size);
+}
+
+void* operator new[](size_t size, const std::nothrow_t& tag) noexcept {
+    return operator new(size, tag);
+}
+
+// GCC 11 and later warn about freeing what operator new returned, since
+// they don't see that it came from malloc.
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+void operator delete(void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, size_t) noexcept {
+    std::free(pointer);
+}
+
+void operator delete(void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+void operator delete[](void* pointer, const std::nothrow_t&) noexcept {
+    std::free(pointer);
+}
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic pop
+#endif
+
+namespace {
+    typedef std::vector<std::string> Corpus;
+
+    struct Result {
+        std::string benchmark;
+        std::string corpus;
+        size_t operations;
+        size_t bytes;
+        double seconds;
+        size_t allocations;
+    };
+
+    // Stop the compiler from optimising away a benchmark's work.
+    volatile long sink;
+
+    std::string number(std::mt19937& random, unsigned max) {
+        return std::to_string(random() % max);
+    }
+
+    // Versions like npm packages: mostly plain X.Y.Z, with some
+    // pre-releases and build metadata.
+    Corpus semVerCorpus(size_t size, std::mt19937& random) {
+        const char* preReleases[] = { "alpha", "beta", "rc", "next", "canary" };
+        Corpus corpus;
+
+        for (size_t i = 0; i < size; ++i) {
+            std::string version = number(random, 20) + "." + number(random, 50) + "." + number(random, 100);
+
+            if (random() % 5 == 0)
+                version += std::string("-") + preReleases[random() % 5] + "." + number(random, 20);
+            if (random() % 20 == 0)
+                version += "+build." + number(random, 10000);
+
+            corpus.push_back(version);
+        }
+
+        return corpus;
+    }
+
+    // Four-part versions like Windows file versions.
+    Corpus windowsCorpus(size_t size, std::mt19937& random) {
+        Corpus corpus;
+
+        for (size_t i = 0; i < size; ++i)
+            corpus.push_back(number(random, 11) + "." + number(random, 4) + "." + number(random, 30000) + "." + number(random, 5000));
+
+        return corpus;
+    }
+
+    // Versions with letters appended to release numbers, like 1.0a.
+    Corpus letterCorpus(size_t size, std::mt19937& random) {
+        Corpus corpus;
+
+        for (size_t i = 0; i < size; ++i) {
+            std::string version = number(random, 5) + "." + number(random, 20);
+            if (random() % 2 == 0)
+                version += "." + number(random, 10);
+
+            version += static_cast<char>('a' + random() % 26);
+            if (random() % 4 == 0)
+                version += "." + number(random, 5);
+
+            corpus.push_back(version);
+        }
+
+        return corpus;
+    }
+
+    // Date-based versions, like 2023.10.17 or 20231017.1.
+    Corpus dateCorpus(size_t size, std::mt19937& random) {
+        Corpus corpus;
+
+        for (size_t i = 0; i < size; ++i) {
+            std::string year = std::to_string(2000 + random() % 25);
+            std::string month = std::to_string(1 + random() % 12);
+            std::string day = std::to_string(1 + random() % 28);
+
+            switch (random() % 3) {
+            case 0:
+                corpus.push_back(year + "." + month + "." + day);
+                break;
+            case 1:
+                corpus.push_back(year + (month.size() == 1 ? "0" : "") + month + (day.size() == 1 ? "0" : "") + day + "." + number(random, 10));
+                break;
+            default:
+                corpus.push_back(year + "." + month + "-" + number(random, 5));
+                break;
+            }
+        }
+
+        return corpus;
+    }
+
+    // Inputs that are expensive to parse or compare.
+    Corpus worstCaseCorpus(size_t size) {
+        std::string longPreRelease("1.0.0-");
+        std::string manyReleaseNumbers;
+        std::string hugeNumbers("1.0.0-");
+
+        for (size_t i = 0; i < 100; ++i) {
+            longPreRelease += (i % 2 == 0 ? "alpha." : "1.");
+            manyReleaseNumbers += std::to_string(i % 10) + ".";
+            hugeNumbers += "20231017120000123456789.";
+        }
+
+        Corpus corpus;
+        for (size_t i = 0; i < size; ++i) {
+            // Vary the last part so that comparisons go through to the end.
+            std::string suffix = std::to_string(i % 10);
+
+            switch (i % 3) {
+            case 0:
+                corpus.push_back(longPreRelease + suffix);
+                break;
+            case 1:
+                corpus.push_back(manyReleaseNumbers + suffix);
+                break;
+            default:
+                corpus.push_back(hugeNumbers + suffix);
+                break;
+            }
+        }
+
+        return corpus;
+    }
+
+    size_t totalBytes(const Corpus& corpus) {
+        size_t bytes = 0;
+        for (const std::string& version : corpus)
+            bytes += version.size();
+
+        return bytes;
+    }
+
+    // Run the function over the corpus repeatedly for at least the minimum
+    // time, and record the average cost of each operation.
+    template<typename Function>
+    Result measure(const std::string& benchmark,
+                   const std::string& corpusName,
+                   const Corpus& corpus,
+                   size_t operationsPerRun,
+                   double minSeconds,
+                   Function function) {
+        Result result = { benchmark, corpusName, 0, 0, 0, 0 };
+        size_t bytesPerRun = totalBytes(corpus);
+
+        while (result.seconds < minSeconds || result.operations == 0) {
+            size_t allocationsBefore = allocationCount;
+            auto start = std::chrono::steady_clock::now();
+
+            function();
+
+            auto end = std::chrono::steady_clock::now();
+            result.allocations += allocationCount - allocationsBefore;
+            result.seconds += std::chrono::duration<double>(end - start).count();
+            result.operations += operationsPerRun;
+            result.bytes += bytesPerRun;
+        }
+
+        return result;
+    }
+
+    void printText(const std::vector<Result>& results) {
+        std::cout << std::left << std::setw(20) << "benchmark"
+                  << std::setw(12) << "corpus"
+                  << std::right << std::setw(14) << "ns/op"
+                  << std::setw(14) << "allocs/op"
+                  << std::setw(14) << "Mop/s"
+                  << std::setw(14) << "MB/s" << "\n";
+
+        for (const Result& result : results) {
+            std::cout << std::left << std::setw(20) << result.benchmark
+                      << std::setw(12) << result.corpus
+                      << std::right << std::fixed << std::setprecision(2)
+                      << std::setw(14) << result.seconds * 1e9 / result.operations
+                      << std::setw(14) << static_cast<double>(result.allocations) / result.operations
+                      << std::setw(14) << result.operations / result.seconds / 1e6
+                      << std::setw(14) << result.bytes / result.seconds / 1e6 << "\n";
+        }
+    }
+
+    void printJson(const std::vector<Result>& results) {
+        std::cout << "[\n";
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& result = results[i];
+
+            std::cout << std::setprecision(6)
+                      << "  {\"benchmark\": \"" << result.benchmark
+                      << "\", \"corpus\": \"" << result.corpus
+                      << "\", \"operations\": " << result.operations
+                      << ", \"ns_per_op\": " << result.seconds * 1e9 / result.operations
+                      << ", \"allocations_per_op\": " << static_cast<double>(result.allocations) / result.operations
+                      << ", \"ops_per_second\": " << result.operations / result.seconds
+                      << ", \"bytes_per_second\": " << result.bytes / result.seconds
+                      << "}" << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+
+        std::cout << "]\n";
+    }
+}
+
+int main(int argc, char** argv) {
+    bool json = false;
+    size_t sortSize = 1000000;
+    double minSeconds = 0.5;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--json") == 0)
+            json = true;
+        else if (std::strcmp(argv[i], "--sort-size") == 0 && i + 1 < argc)
+            sortSize = std::strtoul(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc)
+            minSeconds = std::strtod(argv[++i], nullptr);
+        else {
+            std::cerr << "Usage: benchmarks [--json] [--sort-size N] [--min-time SECONDS]\n";
+            return 1;
+        }
+    }
+
+    std::mt19937 random(12345);
+    const size_t corpusSize = 10000;
+
+    std::vector<std::pair<std::string, Corpus>> corpora;
+    corpora.push_back(std::make_pair("semver", semVerCorpus(corpusSize, random)));
+    corpora.push_back(std::make_pair("windows", windowsCorpus(corpusSize, random)));
+    corpora.push_back(std::make_pair("letter", letterCorpus(corpusSize, random)));
+    corpora.push_back(std::make_pair("date", dateCorpus(corpusSize, random)));
+    corpora.push_back(std::make_pair("worst-case", worstCaseCorpus(corpusSize / 10)));
+
+    std::vector<Result> results;
+    for (const auto& entry : corpora) {
+        const std::string& name = entry.first;
+        const Corpus& corpus = entry.second;
+
+        results.push_back(measure("parse", name, corpus, corpus.size(), minSeconds, [&corpus]() {
+            long total = 0;
+            for (const std::string& version : corpus)
+                total += static_cast<long>(pseudosem::detail::VersionParts(version).releaseNumber(0).value);
+            sink = total;
+        }));
+
+        results.push_back(measure("compare", name, corpus, corpus.size() - 1, minSeconds, [&corpus]() {
+            long total = 0;
+            for (size_t i = 1; i < corpus.size(); ++i)
+                total += pseudosem::compare(corpus[i - 1], corpus[i]);
+            sink = total;
+        }));
+
+        results.push_back(measure("compare-strict", name, corpus, corpus.size() - 1, minSeconds, [&corpus]() {
+            long total = 0;
+            for (size_t i = 1; i < corpus.size(); ++i)
+                total += pseudosem::compare<pseudosem::StrictSemVer>(corpus[i - 1], corpus[i]);
+            sink = total;
+        }));
+
+        std::vector<pseudosem::Version> parsed;
+        for (const std::string& version : corpus)
+            parsed.push_back(pseudosem::Version(version));
+
+        results.push_back(measure("compare-parsed", name, corpus, corpus.size() - 1, minSeconds, [&parsed]() {
+            long total = 0;
+            for (size_t i = 1; i < parsed.size(); ++i)
+                total += parsed[i - 1].compare(parsed[i]);
+            sink = total;
+        }));
+
+        // Compare one version with every version in a table.
+        pseudosem::VersionTable table(corpus);
+        pseudosem::Version query(corpus[corpus.size() / 2]);
+        std::vector<int> comparisons(corpus.size());
+
+        results.push_back(measure("compare-many", name, corpus, corpus.size(), minSeconds, [&table, &query, &comparisons]() {
+            pseudosem::compareMany(query, table, comparisons.data());
+            sink = comparisons.back();
+        }));
+
+        results.push_back(measure("sort-key", name, corpus, corpus.size(), minSeconds, [&corpus]() {
+            long total = 0;
+            for (const std::string& version : corpus)
+                total += pseudosem::sortKey(version).size();
+            sink = total;
+        }));
+    }
+
+    // Sort a large mixed corpus, copying it each run. The copy's cost is
+    // measured separately so it can be subtracted.
+    Corpus large;
+    for (size_t i = 0; large.size() < sortSize; ++i) {
+        const Corpus& corpus = corpora[i % 4].second;
+        large.push_back(corpus[(i / 4) % corpus.size()] + (i % 7 == 0 ? "-rc." + std::to_string(i % 13) : ""));
+    }
+
+    results.push_back(measure("copy", "mixed", large, large.size(), 0, [&large]() {
+        Corpus copy(large);
+        sink = static_cast<long>(copy.size());
+    }));
+
+    results.push_back(measure("sort", "mixed", large, large.size(), 0, [&large]() {
+        Corpus copy(large);
+        pseudosem::sort(copy.begin(), copy.end());
+        sink = static_cast<long>(copy.size());
+    }));
+
+    results.push_back(measure("table+sort", "mixed", large, large.size(), 0, [&large]() {
+        pseudosem::VersionTable table(large);
+        sink = static_cast<long>(table.sortedOrder().size());
+    }));
+
+    results.push_back(measure("std::sort+compare", "mixed", large, large.size(), 0, [&large]() {
+        Corpus copy(large);
+        std::sort(copy.begin(), copy.end(), [](const std::string& a, const std::string& b) {
+            return pseudosem::compare(a, b) < 0;
+        });
+        sink = static_cast<long>(copy.size());
+    }));
+
+    if (json)
+        printJson(results);
+    else
+        printText(results);
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+// The pseudosem_c shared library, which implements pseudosem_c.h on top of
+// the header-only library. Exceptions are caught at the boundary, as they
+// can't propagate through C callers.
+
+#include "pseudosem_c.h"
+#include "pseudosem.h"
+#include "pseudosem/sort.h"
+
+#include <new>
+#include <vector>
+
+struct pseudosem_version {
+    explicit pseudosem_version(std::string ver) : version(std::move(ver)) {}
+
+    pseudosem::Version version;
+};
+
+namespace {
+    template<typename Function>
+    pseudosem_status guarded(Function function) {
+        try {
+            function();
+            return PSEUDOSEM_OK;
+        }
+        catch (std::bad_alloc&) {
+            return PSEUDOSEM_OUT_OF_MEMORY;
+        }
+        catch (...) {
+            return PSEUDOSEM_ERROR;
+        }
+    }
+
+    bool isValidArray(const void* array, size_t count) {
+        return array != nullptr || count == 0;
+    }
+
+    // Parse the versions on multiple threads if there are enough of them.
+    std::vector<pseudosem::detail::VersionParts> parseAll(const pseudosem_string* versions, size_t count, unsigned threads) {
+        std::vector<pseudosem::detail::VersionParts> parts(count);
+        size_t threadCount = pseudosem::detail::threadCount(threads, count, 1024);
+
+        pseudosem::detail::parallelFor(threadCount, [&](size_t i) {
+            for (size_t j = i * count / threadCount; j < (i + 1) * count / threadCount; ++j)
+                parts[j].assign(versions[j].data, versions[j].length);
+        });
+
+        return parts;
+    }
+}
+
+extern "C" {
+    int pseudosem_abi_version(void) {
+        return PSEUDOSEM_C_ABI_VERSION;
+    }
+
+    int pseudosem_compare(const char* data1, size_t length1, const char* data2, size_t length2) {
+        return pseudosem::compare(data1, length1, data2, length2);
+    }
+
+    pseudosem_version* pseudosem_parse(const char* data, size_t length) {
+        if (data == nullptr && length > 0)
+            return nullptr;
+
+        try {
+            return new pseudosem_version(std::string(data, length));
+        }
+        catch (...) {
+            return nullptr;
+        }
+    }
+
+    void pseudosem_free(pseudosem_version* version) {
+        delete version;
+    }
+
+    int pseudosem_compare_parsed(const pseudosem_version* version1, const pseudosem_version* version2) {
+        return version1->version.compare(version2->version);
+    }
+
+    pseudosem_status pseudosem_compare_pairs(const pseudosem_string* versions1,
+                                             const pseudosem_string* versions2,
+                                             size_t count,
+                                             int* results) {
+        if (!isValidArray(versions1, count) || !isValidArray(versions2, count) || !isValidArray(results, count))
+            return PSEUDOSEM_INVALID_ARGUMENT;
+
+        return guarded([&]() {
+            // Compare into a buffer, so that results are untouched on failure.
+            std::vector<int> compared(count);
+            for (size_t i = 0; i < count; ++i)
+                compared[i] = pseudosem::compare(versions1[i].data, versions1[i].length, versions2[i].data, versions2[i].length);
+
+            std::copy(compared.begin(), compared.end(), results);
+        });
+    }
+
+    pseudosem_status pseudosem_compare_each(const pseudosem_string* versions,
+                                            size_t count,
+                                            const char* other,
+                                            size_t otherLength,
+                                            int* results) {
+        if (!isValidArray(versions, count) || !isValidArray(other, otherLength) || !isValidArray(results, count))
+            return PSEUDOSEM_INVALID_ARGUMENT;
+
+        return guarded([&]() {
+            pseudosem::detail::VersionParts otherParts(other, otherLength);
+            pseudosem::detail::VersionParts parts;
+
+            // Parsing can fail partway through, so compare into a buffer.
+            std::vector<int> compared(count);
+            for (size_t i = 0; i < count; ++i) {
+                parts.assign(versions[i].data, versions[i].length);
+                compared[i] = parts.compare(otherParts);
+            }
+
+            std::copy(compared.begin(), compared.end(), results);
+        });
+    }
+
+    pseudosem_status pseudosem_sort(const pseudosem_string* versions, size_t count, unsigned threads, size_t* order) {
+        if (!isValidArray(versions, count) || !isValidArray(order, count))
+            return PSEUDOSEM_INVALID_ARGUMENT;
+
+        return guarded([&]() {
+            std::vector<pseudosem::detail::VersionParts> parts(parseAll(versions, count, threads));
+            std::vector<size_t> sorted(pseudosem::detail::sortedOrder(parts, pseudosem::detail::threadCount(threads, count, 4096)));
+            std::copy(sorted.begin(), sorted.end(), order);
+        });
+    }
+
+    pseudosem_status pseudosem_max(const pseudosem_string* versions, size_t count, size_t* index) {
+        if (versions == nullptr || count == 0 || index == nullptr)
+            return PSEUDOSEM_INVALID_ARGUMENT;
+
+        return guarded([&]() {
+            // Keep the latest version's parts, and reuse another set of parts
+            // for each version compared against it.
+            pseudosem::detail::VersionParts latest(versions[0].data, versions[0].length);
+            pseudosem::detail::VersionParts parts;
+            size_t latestIndex = 0;
+
+            for (size_t i = 1; i < count; ++i) {
+                parts.assign(versions[i].data, versions[i].length);
+                if (parts.compare(latest) > 0) {
+                    std::swap(parts, latest);
+                    latestIndex = i;
+                }
+            }
+
+            *index = latestIndex;
+        });
+    }
+}
@@ -2,231 +2,1143 @@
 #define PSEUDOSEM
 
 #include <string>
-#include <vector>
 #include <algorithm>
-#include <iterator>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <utility>
+
+#if __cplusplus >= 201703L || (defined(_MSVC_LANG) && _MSVC_LANG >= 201703L)
+#include <string_view>
+#define PSEUDOSEM_HAS_STRING_VIEW
+#endif
+
+// Relaxed constexpr functions (C++14) allow versions to be parsed and
+// compared at compile time. Otherwise the same functions are just inline.
+#if defined(__cpp_constexpr) && __cpp_constexpr >= 201304L
+#define PSEUDOSEM_CONSTEXPR constexpr
+#define PSEUDOSEM_HAS_CONSTEXPR
+#else
+#define PSEUDOSEM_CONSTEXPR inline
+#endif
+
+// Parses, comparisons, allocations and exceptions are counted and timed if
+// PSEUDOSEM_INSTRUMENT is defined, as described in
+// pseudosem/instrumentation.h. Otherwise the hooks compile to nothing.
+#ifdef PSEUDOSEM_INSTRUMENT
+#include "pseudosem/instrumentation.h"
+#define PSEUDOSEM_COUNT(counter, amount) ::pseudosem::instrumentation::detail::add(::pseudosem::instrumentation::counter, amount)
+#define PSEUDOSEM_COUNT_COMPARISON(part) ::pseudosem::detail::countComparison(part)
+#define PSEUDOSEM_TIME(operation) ::pseudosem::instrumentation::detail::Timer pseudosemTimer(::pseudosem::instrumentation::operation)
+#else
+#define PSEUDOSEM_COUNT(counter, amount) ((void)0)
+#define PSEUDOSEM_COUNT_COMPARISON(part) ((void)0)
+#define PSEUDOSEM_TIME(operation) ((void)0)
+#endif
+
+// Version strings are classified 16 bytes at a time with SSE2 on x86, or 32
+// bytes at a time with AVX2 if the CPU supports it. Define PSEUDOSEM_NO_SIMD
+// to always classify them one byte at a time.
+#if !defined(PSEUDOSEM_NO_SIMD) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PSEUDOSEM_HAS_SSE2
+#include <emmintrin.h>
+
+#if defined(__AVX2__)
+#define PSEUDOSEM_HAS_AVX2
+#define PSEUDOSEM_TARGET_AVX2
+#include <immintrin.h>
+#elif defined(__GNUC__) || defined(__clang__)
+#define PSEUDOSEM_HAS_AVX2
+#define PSEUDOSEM_DETECT_AVX2
+#define PSEUDOSEM_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#elif defined(_MSC_VER)
+#define PSEUDOSEM_HAS_AVX2
+#define PSEUDOSEM_DETECT_AVX2
+#define PSEUDOSEM_TARGET_AVX2
+#include <immintrin.h>
+#endif
+#endif
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
 
 namespace pseudosem {
     namespace detail {
-        struct VersionParts {
-            // Split a version string into release and pre-release parts.
-            VersionParts(const std::string& ver) {
-                if (ver.empty())
-                    return;
+        // A non-owning view of part of a version string.
+        struct Token {
+            const char* data;
+            size_t size;
+        };
+
+        PSEUDOSEM_CONSTEXPR bool isDigit(char c) {
+            return c >= '0' && c <= '9';
+        }
+
+        PSEUDOSEM_CONSTEXPR bool isDigits(const Token& token) {
+            for (size_t i = 0; i < token.size; ++i) {
+                if (!isDigit(token.data[i]))
+                    return false;
+            }
+
+            return true;
+        }
+
+        PSEUDOSEM_CONSTEXPR bool isOneOf(char c, const char* chars) {
+            for (; *chars != '\0'; ++chars) {
+                if (c == *chars)
+                    return true;
+            }
+
+            return false;
+        }
 
-                // Find first '+' and trim to it.
-                std::string version(ver.substr(0, ver.find('+')));
+        PSEUDOSEM_CONSTEXPR size_t length(const char* str) {
+            size_t size = 0;
+            while (str[size] != '\0')
+                ++size;
 
-                // Split release string.
-                size_t pos = version.find_first_of(" :_-");
-                std::string relStr(version.substr(0, pos));
-                trim(relStr, ".");
+            return size;
+        }
 
-                // Split release portion of version into what should be digit strings.
-                std::vector<std::string> temp(split(relStr, "."));
+        // Fold ASCII letters to lowercase, leaving all other bytes alone so
+        // that the result doesn't depend on the locale.
+        PSEUDOSEM_CONSTEXPR char toLower(char c) {
+            return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : c;
+        }
 
-                if (!temp.empty()) {
-                    // Function to test if string does not contains only digits.
-                    auto notDigits = [](const std::string& str) {
-                        return !std::all_of(str.begin(), str.end(), ::isdigit);
-                    };
+        // Compare two tokens in the same way as std::string::compare, but
+        // ignoring the case of ASCII letters.
+        PSEUDOSEM_CONSTEXPR int compareChars(const Token& token1, const Token& token2) {
+            size_t size = token1.size < token2.size ? token1.size : token2.size;
 
-                    // Unary string to unsigned long converter.
-                    auto toul = [](const std::string& str) {
-                        return std::stoul(str);
-                    };
+            for (size_t i = 0; i < size; ++i) {
+                unsigned char c1 = static_cast<unsigned char>(toLower(token1.data[i]));
+                unsigned char c2 = static_cast<unsigned char>(toLower(token2.data[i]));
 
-                    auto firstNonInt = std::find_if(temp.begin(), temp.end(), notDigits);
+                if (c1 != c2)
+                    return c1 < c2 ? -1 : 1;
+            }
+
+            if (token1.size == token2.size)
+                return 0;
+
+            return token1.size < token2.size ? -1 : 1;
+        }
+
+        // Numbers with at most this many digits always fit in 64 bits.
+        enum { maxFastDigits = 19 };
+
+        PSEUDOSEM_CONSTEXPR Token stripLeadingZeroes(const Token& digits) {
+            size_t zeroes = 0;
+            while (zeroes < digits.size && digits.data[zeroes] == '0')
+                ++zeroes;
 
-                    std::transform(temp.begin(),
-                                   firstNonInt,
-                                   std::back_inserter(releaseNumbers),
-                                   toul);
+            return Token{ digits.data + zeroes, digits.size - zeroes };
+        }
 
-                    if (firstNonInt != temp.end()) {
-                        // If the firstNonInt is digits followed by one or more
-                        // non-digit characters, the digits need to be added as
-                        // a release number.
+        // Convert a string of at most maxFastDigits digits to an integer.
+        PSEUDOSEM_CONSTEXPR uint64_t toUint64(const Token& digits) {
+            uint64_t value = 0;
+            for (size_t i = 0; i < digits.size; ++i)
+                value = value * 10 + static_cast<uint64_t>(digits.data[i] - '0');
+
+            return value;
+        }
+
+        // Compare two strings of digits of any length by their values: a
+        // number with more significant digits is larger, and numbers with the
+        // same number of significant digits compare like their digits.
+        PSEUDOSEM_CONSTEXPR int compareNumbers(const Token& number1, const Token& number2) {
+            Token digits1 = stripLeadingZeroes(number1);
+            Token digits2 = stripLeadingZeroes(number2);
+
+            if (digits1.size != digits2.size)
+                return digits1.size < digits2.size ? -1 : 1;
+
+            return compareChars(digits1, digits2);
+        }
+
+        // A number that has been parsed once, so that it can be compared
+        // repeatedly without looking at its digits unless it is too large to
+        // fit in 64 bits.
+        struct Number {
+            // The number's value if it has at most maxFastDigits digits, or
+            // longNumber, which is larger than any such value, otherwise.
+            uint64_t value;
+            // The number's digits, without leading zeroes, so empty for zero.
+            Token digits;
+        };
 
-                        auto isNotDigit = [](char c) {
-                            return !isdigit(c);
-                        };
+        static const uint64_t longNumber = ~uint64_t(0);
 
-                        auto firstNonIntChar = std::find_if(begin(*firstNonInt),
-                                                            end(*firstNonInt),
-                                                            isNotDigit);
-                        if (firstNonIntChar != end(*firstNonInt)) {
-                            releaseNumbers.push_back(toul(
-                                firstNonInt->substr(0, std::distance(begin(*firstNonInt), firstNonIntChar))));
+        inline Number toNumber(const Token& token) {
+            Token digits = stripLeadingZeroes(token);
+            return Number{ digits.size <= maxFastDigits ? toUint64(digits) : longNumber, digits };
+        }
+
+        inline int compareNumbers(const Number& number1, const Number& number2) {
+            if (number1.value != number2.value)
+                return number1.value < number2.value ? -1 : 1;
+
+            if (number1.value != longNumber)
+                return 0;
+
+            return compareNumbers(number1.digits, number2.digits);
+        }
+
+        // Compare two release or pre-release string identifiers.
+        PSEUDOSEM_CONSTEXPR int compareIdentifiers(const Token& token1, const Token& token2) {
+            bool isInt1 = isDigits(token1);
+            bool isInt2 = isDigits(token2);
+
+            // Integers have lower precedence than non-integer strings.
+            if (isInt1 != isInt2)
+                return isInt1 ? -1 : 1;
+
+            if (isInt1)
+                return compareNumbers(token1, token2);
+
+            return compareChars(token1, token2);
+        }
+
+        // Splits a version string into its release numbers, then its release
+        // strings, then its pre-release strings, reading them one at a time
+        // so that they don't need to be stored. The string is only read as
+        // far as the tokens that have been asked for, so a comparison that
+        // is decided early doesn't read the rest of either version.
+        class VersionReader {
+        public:
+            PSEUDOSEM_CONSTEXPR VersionReader(const char* ver, size_t length) :
+                cursor(ver),
+                end(ver + length),
+                firstReleaseString{ ver, 0 },
+                inRelease(true),
+                inReleaseStrings(false),
+                hasPreRelease(false),
+                preReleaseCount(0) {}
+
+            // Release numbers are the leading tokens in the release portion
+            // of the version that are digits. Once a token that isn't all
+            // digits is found, it and all following tokens are release
+            // strings, though any leading digits of that token are a release
+            // number.
+            PSEUDOSEM_CONSTEXPR bool nextReleaseNumber(Token& number) {
+                Token token{ cursor, 0 };
+                if (inReleaseStrings || !nextReleaseToken(token)) {
+                    inReleaseStrings = true;
+                    return false;
+                }
 
-                            *firstNonInt = firstNonInt->substr(std::distance(begin(*firstNonInt), firstNonIntChar));
+                size_t digitCount = 0;
+                while (digitCount < token.size && isDigit(token.data[digitCount]))
+                    ++digitCount;
+
+                if (digitCount < token.size) {
+                    firstReleaseString = Token{ token.data + digitCount, token.size - digitCount };
+                    inReleaseStrings = true;
+
+                    if (digitCount == 0)
+                        return false;
+                }
+
+                number = Token{ token.data, digitCount };
+                return true;
+            }
+
+            // Get the next release string if areReleaseStrings is true, or
+            // the next pre-release string otherwise. All release numbers must
+            // be read before release strings, and release strings before
+            // pre-release strings.
+            PSEUDOSEM_CONSTEXPR bool nextString(bool areReleaseStrings, Token& token) {
+                if (areReleaseStrings) {
+                    if (firstReleaseString.size > 0) {
+                        token = firstReleaseString;
+                        firstReleaseString.size = 0;
+                        return true;
+                    }
+
+                    return nextReleaseToken(token);
+                }
+
+                // Skip any release strings that weren't read.
+                Token skipped{ cursor, 0 };
+                while (nextReleaseToken(skipped)) {}
+
+                if (nextToken(false, token)) {
+                    ++preReleaseCount;
+                    return true;
+                }
+
+                // A pre-release separator with nothing after it still makes
+                // this a pre-release version.
+                if (preReleaseCount == 0 && hasPreRelease) {
+                    ++preReleaseCount;
+                    token = Token{ end, 0 };
+                    return true;
+                }
+
+                return false;
+            }
+
+        private:
+            const char* cursor;
+            const char* end;
+            Token firstReleaseString;
+            bool inRelease;
+            bool inReleaseStrings;
+            bool hasPreRelease;
+            size_t preReleaseCount;
+
+            static PSEUDOSEM_CONSTEXPR bool isDelimiter(char c) {
+                return c == '.' || c == ' ' || c == ':' || c == '_' || c == '-' || c == '+';
+            }
+
+            PSEUDOSEM_CONSTEXPR bool nextReleaseToken(Token& token) {
+                return nextToken(true, token);
+            }
+
+            // Read the next non-empty token, stopping at the end of the
+            // release portion of the version if releaseOnly is true.
+            PSEUDOSEM_CONSTEXPR bool nextToken(bool releaseOnly, Token& token) {
+                while (cursor != end && (inRelease || !releaseOnly)) {
+                    const char* tokenEnd = cursor;
+                    while (tokenEnd != end && !isDelimiter(*tokenEnd))
+                        ++tokenEnd;
+
+                    Token found{ cursor, static_cast<size_t>(tokenEnd - cursor) };
+
+                    if (tokenEnd == end || *tokenEnd == '+') {
+                        // Ignore everything from the first '+' onwards.
+                        end = tokenEnd;
+                        cursor = end;
+                    }
+                    else {
+                        cursor = tokenEnd + 1;
+
+                        // Spaces, colons, underscores and hyphens separate
+                        // the release and pre-release portions.
+                        if (*tokenEnd != '.' && inRelease) {
+                            inRelease = false;
+                            hasPreRelease = true;
                         }
+                    }
 
-                        releaseStrings.assign(firstNonInt, temp.end());
+                    if (found.size > 0) {
+                        token = found;
+                        return true;
                     }
                 }
 
-                // Now split the pre-release portion of the version string.
-                if (pos != std::string::npos) {
-                    std::string preRelStr(version.substr(pos));
-                    trim(preRelStr, ". :_-");
-                    temp = split(preRelStr, ". :_-");
+                return false;
+            }
+        };
+
+        PSEUDOSEM_CONSTEXPR int compareStrings(VersionReader& reader1,
+                                               VersionReader& reader2,
+                                               bool areReleaseStrings) {
+            Token string1{ nullptr, 0 };
+            Token string2{ nullptr, 0 };
+            bool has1 = reader1.nextString(areReleaseStrings, string1);
+            bool has2 = reader2.nextString(areReleaseStrings, string2);
+
+            // Having release strings makes a version later, but having
+            // pre-release strings makes it earlier.
+            if (has1 != has2)
+                return (has1 ? 1 : -1) * (areReleaseStrings ? 1 : -1);
+
+            while (has1 && has2) {
+                int result = compareIdentifiers(string1, string2);
+                if (result != 0)
+                    return result;
+
+                has1 = reader1.nextString(areReleaseStrings, string1);
+                has2 = reader2.nextString(areReleaseStrings, string2);
+            }
+
+            // Have reached the end of one or both lists of strings. If only
+            // the end of one was reached, it is less.
+            if (has1 == has2)
+                return 0;
 
-                    preReleaseStrings.insert(preReleaseStrings.end(),
-                                             temp.begin(),
-                                             temp.end());
+            return has1 ? 1 : -1;
+        }
+
+        // The part of two versions that decided their comparison, in the
+        // order that the parts are compared.
+        enum DecidingPart {
+            releaseNumbersPart,
+            releaseStringsPart,
+            preReleasePart,
+            noPart
+        };
+
+#ifdef PSEUDOSEM_INSTRUMENT
+        inline void countComparison(DecidingPart part) {
+            static const instrumentation::Counter counters[] = {
+                instrumentation::decidedByReleaseNumbers,
+                instrumentation::decidedByReleaseStrings,
+                instrumentation::decidedByPreRelease,
+                instrumentation::equivalentComparisons
+            };
+
+            instrumentation::detail::add(instrumentation::compares, 1);
+            instrumentation::detail::add(counters[part], 1);
+        }
+#endif
+
+        // Compare two version strings by reading their parts in lockstep,
+        // using the same rules as VersionParts::compare(), but without
+        // storing the parts. Sets part to the part that decided the result.
+        PSEUDOSEM_CONSTEXPR int compareInPlace(const char* ver1, size_t length1, const char* ver2, size_t length2, DecidingPart& part) {
+            VersionReader reader1(ver1, length1);
+            VersionReader reader2(ver2, length2);
+
+            // Missing release numbers are treated as zeroes, so that release
+            // numbers of different lengths are padded to be equal.
+            while (true) {
+                Token number1{ ver1, 0 };
+                Token number2{ ver2, 0 };
+                bool has1 = reader1.nextReleaseNumber(number1);
+                bool has2 = reader2.nextReleaseNumber(number2);
+
+                if (!has1 && !has2)
+                    break;
+
+                int result = compareNumbers(number1, number2);
+                if (result != 0) {
+                    part = releaseNumbersPart;
+                    return result;
+                }
+            }
+
+            int result = compareStrings(reader1, reader2, true);
+            if (result != 0) {
+                part = releaseStringsPart;
+                return result;
+            }
+
+            result = compareStrings(reader1, reader2, false);
+            part = result != 0 ? preReleasePart : noPart;
+            return result;
+        }
+
+        PSEUDOSEM_CONSTEXPR int compareInPlace(const char* ver1, size_t length1, const char* ver2, size_t length2) {
+            DecidingPart part = noPart;
+            return compareInPlace(ver1, length1, ver2, length2, part);
+        }
+
+        // Compare two lists of release or pre-release strings, in the same
+        // way as compareStrings() does while reading them. The lists can be
+        // any containers of Tokens with size() and operator[].
+        template<typename Strings1, typename Strings2>
+        int compareTokens(const Strings1& strings1, const Strings2& strings2, bool areReleaseStrings) {
+            if ((strings1.size() == 0) != (strings2.size() == 0)) {
+                int modifier = 1;
+                if (areReleaseStrings)
+                    modifier = -1;
+
+                if (strings1.size() != 0)
+                    return modifier * -1;
+                else
+                    return modifier * 1;
+            }
+
+            if (strings1.size() == 0)
+                return 0;
+
+            // Compare strings one by one.
+            size_t i = 0;
+            while (i < strings1.size() && i < strings2.size()) {
+                int result = compareIdentifiers(strings1[i], strings2[i]);
+                if (result != 0)
+                    return result;
+
+                ++i;
+            }
+
+            // Have reached the end of one or both lists of strings. If only
+            // the end of one was reached, it is less.
+            if (strings1.size() == strings2.size())
+                return 0;
+            else if (i == strings1.size())
+                return -1;
+            else
+                return 1;
+        }
+
+        // A vector that stores up to N elements inline, and only allocates
+        // if it grows beyond that. T must be trivially copyable.
+        template<typename T, size_t N>
+        class SmallVector {
+        public:
+            SmallVector() : elements(inlineElements), count(0), capacity(N) {}
+
+            SmallVector(const SmallVector& other) : elements(inlineElements), count(0), capacity(N) {
+                assign(other);
+            }
+
+            SmallVector(SmallVector&& other) noexcept : elements(inlineElements), count(0), capacity(N) {
+                take(other);
+            }
+
+            ~SmallVector() {
+                release();
+            }
+
+            SmallVector& operator=(const SmallVector& other) {
+                if (this != &other) {
+                    count = 0;
+                    assign(other);
+                }
+
+                return *this;
+            }
+
+            SmallVector& operator=(SmallVector&& other) noexcept {
+                if (this != &other) {
+                    release();
+                    take(other);
+                }
+
+                return *this;
+            }
+
+            void push_back(const T& value) {
+                if (count == capacity) {
+                    // Copy first, in case value is one of this vector's elements.
+                    T copy = value;
+                    reserve(capacity * 2);
+                    elements[count++] = copy;
+                }
+                else
+                    elements[count++] = value;
+            }
+
+            void clear() {
+                count = 0;
+            }
+
+            size_t size() const { return count; }
+            bool empty() const { return count == 0; }
+
+            T& operator[](size_t i) { return elements[i]; }
+            const T& operator[](size_t i) const { return elements[i]; }
+
+            T* begin() { return elements; }
+            T* end() { return elements + count; }
+            const T* begin() const { return elements; }
+            const T* end() const { return elements + count; }
+
+        private:
+            T* elements;
+            size_t count;
+            size_t capacity;
+            T inlineElements[N];
+
+            void reserve(size_t newCapacity) {
+                if (newCapacity <= capacity)
+                    return;
+
+                PSEUDOSEM_COUNT(allocations, 1);
+                T* newElements = new T[newCapacity];
+                std::copy(elements, elements + count, newElements);
+                release();
+
+                elements = newElements;
+                capacity = newCapacity;
+            }
+
+            void assign(const SmallVector& other) {
+                reserve(other.count);
+                std::copy(other.begin(), other.end(), elements);
+                count = other.count;
+            }
+
+            void take(SmallVector& other) {
+                if (other.elements == other.inlineElements) {
+                    std::copy(other.begin(), other.end(), inlineElements);
+                    elements = inlineElements;
+                    capacity = N;
+                }
+                else {
+                    elements = other.elements;
+                    capacity = other.capacity;
+                    other.elements = other.inlineElements;
+                    other.capacity = N;
                 }
+
+                count = other.count;
+                other.count = 0;
+            }
+
+            void release() {
+                if (elements != inlineElements)
+                    delete[] elements;
+
+                elements = inlineElements;
+                capacity = N;
             }
+        };
+
+        // Bitmasks of the bytes in a block of up to 64 bytes of a version
+        // string that are in each class that the parser cares about, with
+        // bit i set for byte i.
+        struct CharClasses {
+            uint64_t dots;
+            uint64_t separators;
+            uint64_t digits;
+            uint64_t plus;
+        };
+
+        inline CharClasses classifyScalar(const char* block, size_t size) {
+            CharClasses classes{ 0, 0, 0, 0 };
+
+            for (size_t i = 0; i < size; ++i) {
+                uint64_t bit = uint64_t(1) << i;
+                char c = block[i];
 
-            int compare(VersionParts& other) {
+                if (c == '.')
+                    classes.dots |= bit;
+                else if (isOneOf(c, " :_-"))
+                    classes.separators |= bit;
+                else if (isDigit(c))
+                    classes.digits |= bit;
+                else if (c == '+')
+                    classes.plus |= bit;
+            }
+
+            return classes;
+        }
+
+#ifdef PSEUDOSEM_HAS_SSE2
+        inline CharClasses classifySse2(const char* block, size_t size) {
+            // Pad partial blocks with null bytes, which aren't in any class.
+            char padded[64];
+            if (size < 64) {
+                std::memset(padded, 0, sizeof(padded));
+                std::memcpy(padded, block, size);
+                block = padded;
+            }
+
+            CharClasses classes{ 0, 0, 0, 0 };
+            for (size_t i = 0; i < 64; i += 16) {
+                __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+                __m128i separators = _mm_or_si128(
+                    _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(' ')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8(':'))),
+                    _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('_')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('-'))));
+
+                // Bytes are digits if they are less than 10 after subtracting
+                // '0', compared as unsigned bytes by flipping their sign bits.
+                __m128i offsets = _mm_xor_si128(_mm_sub_epi8(bytes, _mm_set1_epi8('0')), _mm_set1_epi8(-128));
+                __m128i digits = _mm_cmplt_epi8(offsets, _mm_set1_epi8(-128 + 10));
+
+                classes.dots |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('.'))))) << i;
+                classes.separators |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(separators))) << i;
+                classes.digits |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(digits))) << i;
+                classes.plus |= uint64_t(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('+'))))) << i;
+            }
+
+            return classes;
+        }
+#endif
+
+#ifdef PSEUDOSEM_HAS_AVX2
+        PSEUDOSEM_TARGET_AVX2 inline CharClasses classifyAvx2(const char* block, size_t size) {
+            char padded[64];
+            if (size < 64) {
+                std::memset(padded, 0, sizeof(padded));
+                std::memcpy(padded, block, size);
+                block = padded;
+            }
+
+            CharClasses classes{ 0, 0, 0, 0 };
+            for (size_t i = 0; i < 64; i += 32) {
+                __m256i bytes = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+                __m256i separators = _mm256_or_si256(
+                    _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(' ')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(':'))),
+                    _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('_')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('-'))));
+
+                // AVX2 only has a signed greater than comparison.
+                __m256i offsets = _mm256_xor_si256(_mm256_sub_epi8(bytes, _mm256_set1_epi8('0')), _mm256_set1_epi8(-128));
+                __m256i digits = _mm256_cmpgt_epi8(_mm256_set1_epi8(-128 + 10), offsets);
+
+                classes.dots |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('.'))))) << i;
+                classes.separators |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(separators))) << i;
+                classes.digits |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(digits))) << i;
+                classes.plus |= uint64_t(static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('+'))))) << i;
+            }
+
+            return classes;
+        }
+#endif
+
+        // Whether the CPU that this is running on supports AVX2.
+        inline bool hasAvx2() {
+#if defined(PSEUDOSEM_HAS_AVX2) && !defined(PSEUDOSEM_DETECT_AVX2)
+            return true;
+#elif defined(PSEUDOSEM_DETECT_AVX2) && (defined(__GNUC__) || defined(__clang__))
+            return __builtin_cpu_supports("avx2");
+#elif defined(PSEUDOSEM_DETECT_AVX2)
+            // AVX2 needs both CPU support and the OS to save YMM registers.
+            int info[4];
+            __cpuid(info, 0);
+            if (info[0] < 7)
+                return false;
+
+            __cpuid(info, 1);
+            bool hasOsxsave = (info[2] & (1 << 27)) != 0;
+            bool hasAvx = (info[2] & (1 << 28)) != 0;
+            if (!hasOsxsave || !hasAvx || (_xgetbv(0) & 6) != 6)
+                return false;
+
+            __cpuidex(info, 7, 0);
+            return (info[1] & (1 << 5)) != 0;
+#else
+            return false;
+#endif
+        }
+
+        typedef CharClasses (*Classifier)(const char*, size_t);
+
+        inline Classifier chooseClassifier() {
+#ifdef PSEUDOSEM_HAS_AVX2
+            if (hasAvx2())
+                return classifyAvx2;
+#endif
+#ifdef PSEUDOSEM_HAS_SSE2
+            return classifySse2;
+#else
+            return classifyScalar;
+#endif
+        }
+
+        // Classify a block of up to 64 bytes with the fastest classifier
+        // that the CPU supports, which is chosen the first time this is
+        // called.
+        inline CharClasses classify(const char* block, size_t size) {
+            static const Classifier classifier = chooseClassifier();
+            return classifier(block, size);
+        }
+
+        inline unsigned countTrailingZeros(uint64_t bits) {
+#if defined(__GNUC__) || defined(__clang__)
+            return static_cast<unsigned>(__builtin_ctzll(bits));
+#elif defined(_MSC_VER) && defined(_M_X64)
+            unsigned long index = 0;
+            _BitScanForward64(&index, bits);
+            return static_cast<unsigned>(index);
+#else
+            unsigned count = 0;
+            while ((bits & 1) == 0) {
+                bits >>= 1;
+                ++count;
+            }
+
+            return count;
+#endif
+        }
+
+        // The character classes of a whole version string, found in a
+        // single pass so that token boundaries can then be found a word at
+        // a time instead of a byte at a time.
+        class CharClassMasks {
+        public:
+            CharClassMasks(const char* ver, size_t length) {
+                for (size_t i = 0; i < length; i += 64)
+                    blocks.push_back(classify(ver + i, std::min<size_t>(64, length - i)));
+            }
+
+            // Find the position of the first byte in [from, to) whose bit is
+            // set in the mask selected from each block, or to if there are
+            // none.
+            template<typename Select>
+            size_t findFirst(size_t from, size_t to, Select select) const {
+                while (from < to) {
+                    uint64_t bits = select(blocks[from / 64]) >> (from % 64);
+                    if (bits != 0) {
+                        size_t found = from + countTrailingZeros(bits);
+                        return found < to ? found : to;
+                    }
+
+                    from = (from / 64 + 1) * 64;
+                }
+
+                return to;
+            }
+
+        private:
+            SmallVector<CharClasses, 8> blocks;
+        };
+
+        struct VersionParts {
+            typedef SmallVector<Number, 4> Numbers;
+            typedef SmallVector<Token, 4> Tokens;
+
+            // An empty version, which is equivalent to "0".
+            VersionParts() {}
+
+            // Split a version string into release and pre-release parts. The
+            // parts are views into the given string, which must outlive this
+            // object.
+            VersionParts(const std::string& ver) {
+                parse(ver.data(), ver.size());
+            }
+
+            VersionParts(const char* ver, size_t length) {
+                parse(ver, length);
+            }
+
+            // Replace the parts with those of another version string, reusing
+            // any memory already allocated.
+            void assign(const char* ver, size_t length) {
+                releaseNumbers.clear();
+                releaseStrings.clear();
+                preReleaseStrings.clear();
+                parse(ver, length);
+            }
+
+            // Get a release number, or zero if there are fewer release numbers.
+            Number releaseNumber(size_t index) const {
+                return index < releaseNumbers.size() ? releaseNumbers[index] : Number{ 0, Token{ nullptr, 0 } };
+            }
+
+            const Numbers& numbers() const { return releaseNumbers; }
+            const Tokens& releaseTokens() const { return releaseStrings; }
+            const Tokens& preReleaseTokens() const { return preReleaseStrings; }
+
+            // The number of release numbers up to and including the last one
+            // that isn't zero.
+            size_t significantReleaseNumbers() const {
+                size_t count = releaseNumbers.size();
+                while (count > 0 && releaseNumbers[count - 1].value == 0)
+                    --count;
+
+                return count;
+            }
+
+            // Neither object is modified, so parts may be compared from
+            // multiple threads at once.
+            int compare(const VersionParts& other) const {
+                DecidingPart part = noPart;
+                int result = compare(other, part);
+                PSEUDOSEM_COUNT_COMPARISON(part);
+                return result;
+            }
+
+            // Compare the parts, and set part to the part that decided the
+            // result.
+            int compare(const VersionParts& other, DecidingPart& part) const {
                 // First compare release numbers.
                 int result = compareReleaseNumbers(other);
+                part = releaseNumbersPart;
 
                 if (result != 0)
                     return result;
 
                 // Release numbers are the same. Check release strings.
                 result = compareStrings(releaseStrings, other.releaseStrings, true);
+                part = releaseStringsPart;
 
                 if (result != 0)
                     return result;
 
                 // Release strings are the same. Check pre-release strings.
-                return compareStrings(preReleaseStrings, other.preReleaseStrings, false);
+                result = compareStrings(preReleaseStrings, other.preReleaseStrings, false);
+                part = result != 0 ? preReleasePart : noPart;
+                return result;
             }
 
-        private:
-            std::vector<unsigned long> releaseNumbers;
-            std::vector<std::string> releaseStrings;
-            std::vector<std::string> preReleaseStrings;
+            // Append a byte string to the given key such that comparing two
+            // keys with memcmp (shorter keys first if one is a prefix of the
+            // other) gives the same order as comparing the parts.
+            //
+            // Each list of parts is encoded as a sequence of tagged elements
+            // followed by an end byte that sorts before every element, so
+            // shorter lists sort first. Trailing zero release numbers are
+            // omitted to get the same effect as padding. Release strings
+            // follow on from release numbers, so their absence sorts first,
+            // but an absence of pre-release strings is encoded as a byte that
+            // sorts after any pre-release element.
+            void appendSortKey(std::string& key) const {
+                size_t numbersCount = significantReleaseNumbers();
+                for (size_t i = 0; i < numbersCount; ++i)
+                    appendNumber(key, releaseNumbers[i]);
+                key.push_back(keyEnd);
 
-            void normaliseReleaseNumbers(VersionParts& other) {
-                if (releaseNumbers.size() < other.releaseNumbers.size())
-                    releaseNumbers.resize(other.releaseNumbers.size(), 0);
-                else if (other.releaseNumbers.size() < releaseNumbers.size())
-                    other.releaseNumbers.resize(releaseNumbers.size(), 0);
+                appendStrings(key, releaseStrings);
+
+                if (preReleaseStrings.empty())
+                    key.push_back(keyNoPreRelease);
+                else
+                    appendStrings(key, preReleaseStrings);
             }
 
-            int compareReleaseNumbers(VersionParts& other) {
-                normaliseReleaseNumbers(other);
+            // Write the canonical form of the version to the sink one byte at
+            // a time with sink.put(c). Versions compare equal if and only if
+            // their canonical forms are the same, and the canonical form of a
+            // version is equivalent to it.
+            //
+            // Trailing zero release numbers are dropped, but there is always
+            // at least one. Release strings follow the release numbers after
+            // dots, and pre-release strings follow a hyphen, separated by
+            // dots. Numbers lose their leading zeroes, letters are lowercased
+            // and build metadata is dropped.
+            template<typename Sink>
+            void writeCanonical(Sink& sink) const {
+                size_t numbersCount = significantReleaseNumbers();
+                if (numbersCount == 0)
+                    sink.put('0');
 
-                for (size_t i = 0; i < releaseNumbers.size(); ++i) {
-                    if (releaseNumbers[i] < other.releaseNumbers[i])
-                        return -1;
+                for (size_t i = 0; i < numbersCount; ++i) {
+                    if (i > 0)
+                        sink.put('.');
+                    writeDigits(sink, releaseNumbers[i].digits);
+                }
 
-                    if (other.releaseNumbers[i] < releaseNumbers[i])
-                        return 1;
+                for (const Token& token : releaseStrings) {
+                    sink.put('.');
+                    writeIdentifier(sink, token);
                 }
 
-                return 0;
+                for (size_t i = 0; i < preReleaseStrings.size(); ++i) {
+                    sink.put(i == 0 ? '-' : '.');
+                    writeIdentifier(sink, preReleaseStrings[i]);
+                }
             }
 
-            static int compareStrings(const std::vector<std::string>& strings1,
-                                      const std::vector<std::string>& strings2,
-                                      bool areReleaseStrings) {
-                if (strings1.empty() != strings2.empty()) {
-                    int modifier = 1;
-                    if (areReleaseStrings)
-                        modifier = -1;
-
-                    if (!strings1.empty())
-                        return modifier * -1;
-                    else
-                        return modifier * 1;
-                }
-
-                if (strings1.empty())
-                    return 0;
-
-                auto isDigits = [](const std::string& str) {
-                    return std::all_of(str.begin(), str.end(), ::isdigit);
-                };
-
-                // Compare pre-release strings one by one.
-                size_t i = 0;
-                while (i < strings1.size() && i < strings2.size()) {
-                    bool v1IsInt = isDigits(strings1[i]);
-                    bool v2IsInt = isDigits(strings2[i]);
-
-                    // Integers have lower precedence than non-integer strings.
-                    if (v1IsInt != v2IsInt) {
-                        if (v1IsInt)
-                            return -1;
-                        else
-                            return 1;
-                    }
+            // Point the parts at a copy of the string that they were parsed
+            // from, which starts at to instead of from.
+            void rebase(const char* from, const char* to) {
+                for (Number& number : releaseNumbers)
+                    rebase(number.digits, from, to);
+
+                rebase(releaseStrings, from, to);
+                rebase(preReleaseStrings, from, to);
+            }
 
-                    if (v1IsInt) {
-                        // Compare integer values.
-                        unsigned long v1Int = std::stoul(strings1[i]);
-                        unsigned long v2Int = std::stoul(strings2[i]);
+        private:
+            Numbers releaseNumbers;
+            Tokens releaseStrings;
+            Tokens preReleaseStrings;
+
+            // Split the version in the same way as VersionReader, but using
+            // bitmasks of the version's characters to find each boundary.
+            void parse(const char* ver, size_t length) {
+                PSEUDOSEM_TIME(parseOperation);
+                CharClassMasks masks(ver, length);
+
+                // Ignore everything from the first '+' onwards.
+                size_t end = masks.findFirst(0, length, [](const CharClasses& c) { return c.plus; });
+                size_t releaseEnd = masks.findFirst(0, end, [](const CharClasses& c) { return c.separators; });
 
-                        if (v1Int < v2Int)
-                            return -1;
-                        if (v2Int < v1Int)
-                            return 1;
+                bool inReleaseStrings = false;
+                for (size_t start = 0; start < releaseEnd; ) {
+                    size_t tokenEnd = masks.findFirst(start, releaseEnd, [](const CharClasses& c) { return c.dots; });
+
+                    if (tokenEnd == start) {
+                        // Skip empty tokens.
                     }
+                    else if (inReleaseStrings)
+                        releaseStrings.push_back(Token{ ver + start, tokenEnd - start });
                     else {
-                        // Compare string values.
-                        if (strings1[i] < strings2[i])
-                            return -1;
+                        // Any leading digits of the first token that isn't
+                        // all digits are still a release number.
+                        size_t digitsEnd = masks.findFirst(start, tokenEnd, [](const CharClasses& c) { return ~c.digits; });
+                        if (digitsEnd > start)
+                            releaseNumbers.push_back(toNumber(Token{ ver + start, digitsEnd - start }));
 
-                        if (strings2[i] < strings1[i])
-                            return 1;
+                        if (digitsEnd < tokenEnd) {
+                            releaseStrings.push_back(Token{ ver + digitsEnd, tokenEnd - digitsEnd });
+                            inReleaseStrings = true;
+                        }
                     }
 
-                    ++i;
+                    start = tokenEnd + 1;
                 }
 
-                // Have reached the end of one or both pre-release string vectors.
-                // If only the end of one was reached, it is less.
-                if (strings1.size() == strings2.size())
-                    return 0;
-                else if (i == strings1.size())
-                    return -1;
-                else
-                    return 1;
+                for (size_t start = releaseEnd + 1; start < end; ) {
+                    size_t tokenEnd = masks.findFirst(start, end, [](const CharClasses& c) { return c.dots | c.separators; });
+                    if (tokenEnd > start)
+                        preReleaseStrings.push_back(Token{ ver + start, tokenEnd - start });
+
+                    start = tokenEnd + 1;
+                }
+
+                // A pre-release separator with nothing after it still makes
+                // this a pre-release version.
+                if (preReleaseStrings.empty() && releaseEnd != end)
+                    preReleaseStrings.push_back(Token{ ver + end, 0 });
+
+                PSEUDOSEM_COUNT(parses, 1);
+                PSEUDOSEM_COUNT(parsedTokens, releaseNumbers.size() + releaseStrings.size() + preReleaseStrings.size());
             }
 
-            // Trim start and end of a string, removing any of the given characters.
-            static void trim(std::string& str, const std::string& toTrim) {
-                size_t pos = str.find_first_not_of(toTrim);
-                if (pos != 0)
-                    str.erase(0, str.find_first_not_of(toTrim));
+            template<typename Sink>
+            static void writeDigits(Sink& sink, const Token& digits) {
+                if (digits.size == 0)
+                    sink.put('0');
+
+                for (size_t i = 0; i < digits.size; ++i)
+                    sink.put(digits.data[i]);
+            }
+
+            template<typename Sink>
+            static void writeIdentifier(Sink& sink, const Token& token) {
+                if (isDigits(token))
+                    writeDigits(sink, stripLeadingZeroes(token));
+                else {
+                    for (size_t i = 0; i < token.size; ++i)
+                        sink.put(toLower(token.data[i]));
+                }
+            }
+
+            static void rebase(Token& token, const char* from, const char* to) {
+                // Zero has no digits to point at.
+                if (token.data != nullptr)
+                    token.data = to + (token.data - from);
+            }
 
-                str.erase(str.find_last_not_of(toTrim) + 1);
+            static void rebase(Tokens& tokens, const char* from, const char* to) {
+                for (Token& token : tokens)
+                    rebase(token, from, to);
             }
 
-            // Split a string on any of the given characters.
-            static std::vector<std::string> split(const std::string& str,
-                                                  const std::string& splitOn) {
-                std::vector<std::string> tokens;
-                size_t tokenStart = 0;
-                size_t tokenEnd = 0;
+            int compareReleaseNumbers(const VersionParts& other) const {
+                // Missing release numbers are treated as zeroes, so that
+                // release numbers of different lengths are padded to be equal.
+                size_t size = std::min(releaseNumbers.size(), other.releaseNumbers.size());
 
-                do {
-                    tokenEnd = str.find_first_of(splitOn, tokenStart);
+                for (size_t i = 0; i < size; ++i) {
+                    const Number& number = releaseNumbers[i];
+                    const Number& otherNumber = other.releaseNumbers[i];
 
-                    if (tokenEnd == std::string::npos) {
-                        tokens.push_back(str.substr(tokenStart));
+                    // Only numbers too long to have a value need a closer look.
+                    if (number.value != otherNumber.value || number.value == longNumber) {
+                        int result = compareNumbers(number, otherNumber);
+                        if (result != 0)
+                            return result;
+                    }
+                }
+
+                for (size_t i = size; i < releaseNumbers.size(); ++i) {
+                    if (releaseNumbers[i].value != 0)
+                        return 1;
+                }
+
+                for (size_t i = size; i < other.releaseNumbers.size(); ++i) {
+                    if (other.releaseNumbers[i].value != 0)
+                        return -1;
+                }
+
+                return 0;
+            }
+
+            enum KeyTag : char {
+                keyEnd = 0x00,
+                keyNumber = 0x01,
+                keyString = 0x02,
+                keyNoPreRelease = 0x03,
+                keyLongNumber = sizeof(uint64_t) + 2
+            };
+
+            // Numbers of up to maxFastDigits digits are encoded as a byte
+            // giving one more than their number of significant bytes,
+            // followed by those bytes in big-endian order, so that the
+            // encoding never starts with keyEnd. Longer numbers are always
+            // larger, so are encoded as keyLongNumber, which is greater than
+            // any of those first bytes, then their number of digits, then
+            // their digits.
+            static void appendNumber(std::string& key, const Number& number) {
+                if (number.value != longNumber)
+                    appendNumber(key, number.value);
+                else {
+                    key.push_back(keyLongNumber);
+                    appendNumber(key, static_cast<uint64_t>(number.digits.size));
+                    key.append(number.digits.data, number.digits.size);
+                }
+            }
+
+            static void appendNumber(std::string& key, uint64_t value) {
+                char bytes[sizeof(uint64_t)];
+                size_t count = 0;
+                while (value > 0) {
+                    bytes[count++] = static_cast<char>(value & 0xFF);
+                    value >>= 8;
+                }
+
+                key.push_back(static_cast<char>(count + 1));
+                while (count > 0)
+                    key.push_back(bytes[--count]);
+            }
+
+            static void appendStrings(std::string& key, const Tokens& strings) {
+                for (const Token& token : strings) {
+                    if (isDigits(token)) {
+                        // Integers have lower precedence than non-integer
+                        // strings, so have a lower tag.
+                        key.push_back(keyNumber);
+                        appendNumber(key, toNumber(token));
+                    }
+                    else {
+                        // Escape null bytes as 00 FF and terminate with 00 01,
+                        // so that a string sorts before any longer string
+                        // that it is a prefix of. Letters are lowercased, as
+                        // strings are compared case-insensitively.
+                        key.push_back(keyString);
+                        for (size_t i = 0; i < token.size; ++i) {
+                            key.push_back(toLower(token.data[i]));
+                            if (token.data[i] == '\x00')
+                                key.push_back('\xFF');
+                        }
+                        key.push_back('\x00');
+                        key.push_back('\x01');
                     }
-                    else if (tokenEnd != tokenStart)
-                        tokens.push_back(str.substr(tokenStart, tokenEnd - tokenStart));
+                }
+
+                key.push_back(keyEnd);
+            }
+
+            static int compareStrings(const Tokens& strings1,
+                                      const Tokens& strings2,
+                                      bool areReleaseStrings) {
+                return compareTokens(strings1, strings2, areReleaseStrings);
+            }
+        };
+
+        // Appends a canonical form to a string.
+        struct StringSink {
+            std::string& out;
+
+            void put(char c) {
+                out.push_back(c);
+            }
+        };
 
-                    tokenStart = tokenEnd + 1;
-                } while (tokenEnd != std::string::npos);
+        // Hashes a canonical form with 64-bit FNV-1a as it is written, so
+        // that it never needs to be stored.
+        struct HashSink {
+            uint64_t state;
 
-                return tokens;
+            void put(char c) {
+                state = (state ^ static_cast<unsigned char>(c)) * 1099511628211ULL;
             }
         };
+
+        inline size_t hashCanonical(const VersionParts& parts) {
+            HashSink sink{ 14695981039346656037ULL };
+            parts.writeCanonical(sink);
+            return static_cast<size_t>(sink.state);
+        }
     }
 
-    int compare(const std::string& ver1, const std::string ver2) {
+    inline int compare(const char* ver1, size_t length1, const char* ver2, size_t length2) {
         /* Version strings have a wide variety of possible formats.
         The precedence rules set out by Semantic Versioning <http://semver.org>
         are sufficient for comparisons, with the following extensions:
 
-        1. Strings must be lowercased before comparison.
+        1. Strings are compared as if lowercased, folding ASCII letters only.
         2. Spaces (" "), colons (":") and underscores ("_") should be treated as
         separator characters between prerelease version identifiers.
         3. Version integers should be allowed to contain leading zeroes.
@@ -236,11 +1148,292 @@ namespace pseudosem {
         version or metadata) to equal length before comparison.
         */
 
-        detail::VersionParts v1(ver1);
-        detail::VersionParts v2(ver2);
+        // Read both versions in lockstep, so that most comparisons are
+        // decided by their first few tokens without parsing the rest.
+        PSEUDOSEM_TIME(compareOperation);
+        detail::DecidingPart part = detail::noPart;
+        int result = detail::compareInPlace(ver1, length1, ver2, length2, part);
+        PSEUDOSEM_COUNT_COMPARISON(part);
+        return result;
+    }
+
+    inline int compare(const std::string& ver1, const std::string& ver2) {
+        return compare(ver1.data(), ver1.size(), ver2.data(), ver2.size());
+    }
+
+    // Comparing C strings or string views can be done at compile time if
+    // PSEUDOSEM_HAS_CONSTEXPR is defined, e.g.
+    // static_assert(pseudosem::compare("1.4.0-rc.1", "1.4.0") < 0, "").
+    PSEUDOSEM_CONSTEXPR int compare(const char* ver1, const char* ver2) {
+        return detail::compareInPlace(ver1, detail::length(ver1), ver2, detail::length(ver2));
+    }
+
+#ifdef PSEUDOSEM_HAS_STRING_VIEW
+    PSEUDOSEM_CONSTEXPR int compare(std::string_view ver1, std::string_view ver2) {
+        return detail::compareInPlace(ver1.data(), ver1.size(), ver2.data(), ver2.size());
+    }
+#endif
+
+    // Policies for compare<Policy>(), which gives the same results as
+    // compare() for any versions, but suits different inputs. AnyVersions
+    // compares versions in the same way as compare(). StrictSemVer suits
+    // versions that are mostly plain MAJOR.MINOR.PATCH versions: it reads
+    // their release numbers directly until they differ, and only falls back
+    // to compare() when it reaches anything else, such as a pre-release of
+    // the same release.
+    struct AnyVersions {};
+    struct StrictSemVer {};
+
+    namespace detail {
+        // Read a number of at most maxFastDigits digits from ver at i, or
+        // return false if there isn't one.
+        PSEUDOSEM_CONSTEXPR bool readPlainNumber(const char* ver, size_t length, size_t& i, uint64_t& number) {
+            size_t start = i;
+            number = 0;
+            while (i < length && isDigit(ver[i])) {
+                if (i - start == maxFastDigits)
+                    return false;
+
+                number = number * 10 + static_cast<uint64_t>(ver[i] - '0');
+                ++i;
+            }
+
+            return i > start;
+        }
+
+        // Compare release numbers that are separated by single dots, and
+        // return true if they decide the comparison. Leading digits are a
+        // release number whatever follows them, so the first numbers that
+        // differ decide it.
+        PSEUDOSEM_CONSTEXPR bool comparePlain(const char* ver1, size_t length1, const char* ver2, size_t length2, int& result) {
+            size_t i = 0;
+            size_t j = 0;
+
+            while (true) {
+                uint64_t number1 = 0;
+                uint64_t number2 = 0;
+                if (!readPlainNumber(ver1, length1, i, number1) || !readPlainNumber(ver2, length2, j, number2))
+                    return false;
+
+                if (number1 != number2) {
+                    result = number1 < number2 ? -1 : 1;
+                    return true;
+                }
+
+                bool end1 = i == length1 || ver1[i] == '+';
+                bool end2 = j == length2 || ver2[j] == '+';
+                if (end1 && end2) {
+                    result = 0;
+                    return true;
+                }
+
+                if (end1 || end2 || ver1[i] != '.' || ver2[j] != '.')
+                    return false;
+
+                ++i;
+                ++j;
+            }
+        }
+
+        PSEUDOSEM_CONSTEXPR int compareWith(AnyVersions, const char* ver1, size_t length1, const char* ver2, size_t length2) {
+            return compareInPlace(ver1, length1, ver2, length2);
+        }
+
+        PSEUDOSEM_CONSTEXPR int compareWith(StrictSemVer, const char* ver1, size_t length1, const char* ver2, size_t length2) {
+            int result = 0;
+            if (comparePlain(ver1, length1, ver2, length2, result))
+                return result;
+
+            return compareInPlace(ver1, length1, ver2, length2);
+        }
+    }
+
+    template<typename Policy>
+    PSEUDOSEM_CONSTEXPR int compare(const char* ver1, size_t length1, const char* ver2, size_t length2) {
+        return detail::compareWith(Policy(), ver1, length1, ver2, length2);
+    }
+
+    template<typename Policy>
+    inline int compare(const std::string& ver1, const std::string& ver2) {
+        return compare<Policy>(ver1.data(), ver1.size(), ver2.data(), ver2.size());
+    }
+
+    // Encode a version as a byte string such that comparing the byte
+    // strings of two versions with memcmp (or std::string::compare) gives
+    // the same result as comparing the versions. This allows versions to be
+    // sorted, indexed and range-scanned by systems that only support byte
+    // comparisons.
+    inline std::string sortKey(const char* ver, size_t length) {
+        std::string key;
+        detail::VersionParts(ver, length).appendSortKey(key);
+        return key;
+    }
+
+    inline std::string sortKey(const std::string& ver) {
+        return sortKey(ver.data(), ver.size());
+    }
+
+    // Get the canonical form of a version, which is equivalent to it and is
+    // the same for all equivalent versions, e.g. "1", "1.0.0", "01.0" and
+    // "1.0+build" are all "1", and "1.0.0-RC.01" is "1-rc.1".
+    inline std::string canonical(const char* ver, size_t length) {
+        std::string result;
+        detail::StringSink sink{ result };
+        detail::VersionParts(ver, length).writeCanonical(sink);
+        return result;
+    }
+
+    inline std::string canonical(const std::string& ver) {
+        return canonical(ver.data(), ver.size());
+    }
+
+    // Hash a version's canonical form without creating it, so that
+    // equivalent versions have equal hashes.
+    inline size_t hash(const char* ver, size_t length) {
+        return detail::hashCanonical(detail::VersionParts(ver, length));
+    }
 
-        return v1.compare(v2);
+    inline size_t hash(const std::string& ver) {
+        return hash(ver.data(), ver.size());
     }
+
+    // A version that is parsed once on construction, so that it can be
+    // compared repeatedly without reparsing, e.g. as a std::sort, std::map or
+    // std::set element. Comparison does not modify either version, so const
+    // Versions can be shared between threads.
+    class Version {
+    public:
+        Version() : parts(text) {}
+
+        explicit Version(std::string ver) : text(std::move(ver)), parts(text) {}
+
+        explicit Version(const char* ver) : text(ver), parts(text) {}
+
+        Version(const Version& other) : text(other.text), parts(other.parts) {
+            parts.rebase(other.text.data(), text.data());
+        }
+
+        Version(Version&& other) noexcept : parts(std::move(other.parts)) {
+            const char* otherData = other.text.data();
+            text = std::move(other.text);
+            other.text.clear();
+            parts.rebase(otherData, text.data());
+        }
+
+        Version& operator=(const Version& other) {
+            if (this != &other) {
+                text = other.text;
+                parts = other.parts;
+                parts.rebase(other.text.data(), text.data());
+            }
+
+            return *this;
+        }
+
+        Version& operator=(Version&& other) noexcept {
+            if (this != &other) {
+                const char* otherData = other.text.data();
+                text = std::move(other.text);
+                parts = std::move(other.parts);
+                other.text.clear();
+                parts.rebase(otherData, text.data());
+            }
+
+            return *this;
+        }
+
+        // Returns less than, equal to or greater than zero if this version
+        // is earlier than, equivalent to or later than the other version.
+        int compare(const Version& other) const {
+            return parts.compare(other.parts);
+        }
+
+        // Returns a byte string that sorts in the same order as this version
+        // when compared with memcmp, or std::string::compare.
+        std::string sortKey() const {
+            std::string key;
+            parts.appendSortKey(key);
+            return key;
+        }
+
+        // Returns the canonical form of this version, which is the same for
+        // all equivalent versions.
+        std::string canonical() const {
+            std::string result;
+            detail::StringSink sink{ result };
+            parts.writeCanonical(sink);
+            return result;
+        }
+
+        // Returns a hash that is the same for all equivalent versions.
+        size_t hash() const {
+            return detail::hashCanonical(parts);
+        }
+
+        // Replace this version with another, reusing any memory already
+        // allocated.
+        void assign(const char* ver, size_t length) {
+            text.assign(ver, length);
+            parts.assign(text.data(), text.size());
+        }
+
+        void assign(const std::string& ver) {
+            assign(ver.data(), ver.size());
+        }
+
+        // The string that this version was parsed from.
+        const std::string& str() const {
+            return text;
+        }
+
+        // The parsed version, for use by the rest of pseudosem.
+        const detail::VersionParts& versionParts() const {
+            return parts;
+        }
+
+    private:
+        std::string text;
+        detail::VersionParts parts;
+    };
+
+    inline int compare(const Version& ver1, const Version& ver2) {
+        return ver1.compare(ver2);
+    }
+
+    inline bool operator==(const Version& ver1, const Version& ver2) {
+        return ver1.compare(ver2) == 0;
+    }
+
+    inline bool operator!=(const Version& ver1, const Version& ver2) {
+        return ver1.compare(ver2) != 0;
+    }
+
+    inline bool operator<(const Version& ver1, const Version& ver2) {
+        return ver1.compare(ver2) < 0;
+    }
+
+    inline bool operator>(const Version& ver1, const Version& ver2) {
+        return ver1.compare(ver2) > 0;
+    }
+
+    inline bool operator<=(const Version& ver1, const Version& ver2) {
+        return ver1.compare(ver2) <= 0;
+    }
+
+    inline bool operator>=(const Version& ver1, const Version& ver2) {
+        return ver1.compare(ver2) >= 0;
+    }
+}
+
+namespace std {
+    // Hashes versions consistently with operator==, so that equivalent
+    // versions are the same key in unordered containers.
+    template<>
+    struct hash<pseudosem::Version> {
+        size_t operator()(const pseudosem::Version& version) const {
+            return version.hash();
+        }
+    };
 }
 
 #endif
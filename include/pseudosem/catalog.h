@@ -0,0 +1,389 @@
+#ifndef PSEUDOSEM_CATALOG
+#define PSEUDOSEM_CATALOG
+
+#include "../pseudosem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace pseudosem {
+    namespace detail {
+        // Epoch-based reclamation for objects that are read by many threads
+        // and replaced by one writer at a time. Readers never wait: they
+        // count themselves into the current epoch for as long as they hold
+        // pointers to shared objects. Objects that the writer replaces are
+        // retired, and only deleted once every reader that could have seen
+        // them has left its epoch.
+        class EpochDomain {
+        public:
+            EpochDomain() : epoch(0) {
+                for (Shard& shard : shards) {
+                    shard.readers[0].store(0, std::memory_order_relaxed);
+                    shard.readers[1].store(0, std::memory_order_relaxed);
+                }
+            }
+
+            // No readers may be active when the domain is destroyed.
+            ~EpochDomain() {
+                for (std::vector<Retired>& objects : retired)
+                    destroy(objects);
+            }
+
+            EpochDomain(const EpochDomain&) = delete;
+            EpochDomain& operator=(const EpochDomain&) = delete;
+
+            // Pins the epoch that was current when it was constructed, so
+            // that no object read while it exists is deleted.
+            class Guard {
+            public:
+                explicit Guard(EpochDomain& domain) : domain(domain), shard(threadShard()) {
+                    // Retry if the writer moved on between reading the epoch
+                    // and counting this reader into it.
+                    while (true) {
+                        uint64_t current = domain.epoch.load();
+                        parity = static_cast<size_t>(current & 1);
+                        domain.shards[shard].readers[parity].fetch_add(1);
+
+                        if (domain.epoch.load() == current)
+                            break;
+
+                        domain.shards[shard].readers[parity].fetch_sub(1);
+                    }
+                }
+
+                ~Guard() {
+                    domain.shards[shard].readers[parity].fetch_sub(1, std::memory_order_release);
+                }
+
+                Guard(const Guard&) = delete;
+                Guard& operator=(const Guard&) = delete;
+
+            private:
+                EpochDomain& domain;
+                size_t shard;
+                size_t parity;
+            };
+
+            // Delete an object once no reader can still be reading it. Must
+            // only be called by the writer, after the object was unlinked.
+            template<typename T>
+            void retire(const T* object) {
+                Retired entry = { object, [](const void* pointer) { delete static_cast<const T*>(pointer); } };
+                retired[epoch.load(std::memory_order_relaxed) & 1].push_back(entry);
+            }
+
+            // Move on to the next epoch if every reader from the previous
+            // one has finished, deleting the objects retired during it. Must
+            // only be called by the writer. Returns false without waiting if
+            // there are still readers in the previous epoch.
+            bool tryAdvance() {
+                uint64_t current = epoch.load(std::memory_order_relaxed);
+                size_t previous = static_cast<size_t>((current + 1) & 1);
+
+                for (Shard& shard : shards) {
+                    if (shard.readers[previous].load() != 0)
+                        return false;
+                }
+
+                // Readers in the previous epoch have all gone, and objects
+                // retired during it were unlinked before the current epoch
+                // started, so no reader can have them.
+                destroy(retired[previous]);
+                epoch.store(current + 1);
+                return true;
+            }
+
+        private:
+            static const size_t shardCount = 64;
+
+            // Readers are spread over cache-line-sized shards so that they
+            // don't contend on one counter.
+            struct alignas(64) Shard {
+                std::atomic<size_t> readers[2];
+            };
+
+            struct Retired {
+                const void* object;
+                void (*destroy)(const void*);
+            };
+
+            std::atomic<uint64_t> epoch;
+            Shard shards[shardCount];
+            std::vector<Retired> retired[2];
+
+            static size_t threadShard() {
+                static thread_local size_t shard = std::hash<std::thread::id>()(std::this_thread::get_id()) % shardCount;
+                return shard;
+            }
+
+            static void destroy(std::vector<Retired>& objects) {
+                for (const Retired& entry : objects)
+                    entry.destroy(entry.object);
+
+                objects.clear();
+            }
+        };
+    }
+
+    // A map from package names to sorted lists of their versions, for one
+    // writer thread and any number of reader threads. Readers see immutable
+    // snapshots of each package's versions and never wait for the writer.
+    // The writer adds versions in batches, merging each package's new
+    // versions into its existing list, which is then swapped in atomically.
+    //
+    // Each package's versions are always read from a single batch, but a
+    // batch that updates several packages may become visible to readers
+    // one package at a time.
+    class VersionCatalog {
+    private:
+        struct Package;
+
+    public:
+        // A sorted range of versions of one package, latest last. Only
+        // valid while the Reader that it was obtained from exists.
+        class Versions {
+        public:
+            typedef const Version* iterator;
+
+            Versions() : first(nullptr), last(nullptr) {}
+
+            iterator begin() const { return first; }
+            iterator end() const { return last; }
+            size_t size() const { return static_cast<size_t>(last - first); }
+            bool empty() const { return first == last; }
+
+            // The latest version, or nullptr if there are none.
+            const Version* latest() const {
+                return empty() ? nullptr : last - 1;
+            }
+
+            // The latest version for which the predicate returns true, or
+            // nullptr if there are none, e.g. latestMatching([&](const
+            // pseudosem::Version& v) { return constraint.matches(v); }).
+            template<typename Predicate>
+            const Version* latestMatching(Predicate predicate) const {
+                for (iterator it = last; it != first; --it) {
+                    if (predicate(it[-1]))
+                        return it - 1;
+                }
+
+                return nullptr;
+            }
+
+            // The first version that isn't earlier than the given version.
+            iterator lowerBound(const Version& version) const {
+                return std::lower_bound(first, last, version);
+            }
+
+            // The first version that is later than the given version.
+            iterator upperBound(const Version& version) const {
+                return std::upper_bound(first, last, version);
+            }
+
+        private:
+            friend class VersionCatalog;
+
+            Versions(iterator first, iterator last) : first(first), last(last) {}
+
+            iterator first;
+            iterator last;
+        };
+
+        // A reader's view of the catalog. Versions read through it remain
+        // valid until it is destroyed, so keep readers short-lived to let
+        // replaced versions be freed.
+        class Reader {
+        public:
+            explicit Reader(const VersionCatalog& catalog) : catalog(catalog), guard(catalog.domain) {}
+
+            // The versions of the given package, which are empty if it
+            // has none.
+            Versions versions(const std::string& package) const {
+                const Package* found = catalog.findPackage(package);
+                if (found == nullptr)
+                    return Versions();
+
+                const std::vector<Version>* list = found->versions.load(std::memory_order_acquire);
+                return Versions(list->data(), list->data() + list->size());
+            }
+
+        private:
+            const VersionCatalog& catalog;
+            detail::EpochDomain::Guard guard;
+        };
+
+        typedef std::vector<std::pair<std::string, std::string>> Batch;
+
+        VersionCatalog() : packageCount(0) {
+            table.store(new Table(16), std::memory_order_relaxed);
+        }
+
+        // No readers may be active when the catalog is destroyed.
+        ~VersionCatalog() {
+            Table* current = table.load(std::memory_order_relaxed);
+            for (size_t i = 0; i < current->capacity; ++i)
+                delete current->slots[i].load(std::memory_order_relaxed);
+
+            delete current;
+        }
+
+        VersionCatalog(const VersionCatalog&) = delete;
+        VersionCatalog& operator=(const VersionCatalog&) = delete;
+
+        // Add a batch of (package, version) pairs. Versions that a package
+        // already has, with exactly the same string, are ignored. Versions
+        // that are equivalent to existing ones are kept after them. Calls
+        // are serialised, but are meant to come from one ingest thread.
+        void ingest(const Batch& batch) {
+            std::lock_guard<std::mutex> writeLock(writeMutex);
+
+            // Parse each version once, and group the batch by package in
+            // version order.
+            std::vector<std::pair<const std::string*, Version>> entries;
+            entries.reserve(batch.size());
+            for (const auto& entry : batch)
+                entries.push_back(std::make_pair(&entry.first, Version(entry.second)));
+
+            std::stable_sort(entries.begin(), entries.end(), [](const std::pair<const std::string*, Version>& a,
+                                                                const std::pair<const std::string*, Version>& b) {
+                int result = a.first->compare(*b.first);
+                return result != 0 ? result < 0 : a.second < b.second;
+            });
+
+            for (size_t start = 0; start < entries.size(); ) {
+                size_t end = start + 1;
+                while (end < entries.size() && *entries[end].first == *entries[start].first)
+                    ++end;
+
+                Package* package = findOrAddPackage(*entries[start].first);
+                const std::vector<Version>* oldVersions = package->versions.load(std::memory_order_relaxed);
+                package->versions.store(merge(*oldVersions, entries, start, end), std::memory_order_release);
+                domain.retire(oldVersions);
+
+                start = end;
+            }
+
+            domain.tryAdvance();
+        }
+
+        // The number of packages that have versions.
+        size_t packages() const {
+            return packageCount.load(std::memory_order_acquire);
+        }
+
+    private:
+        struct Package {
+            explicit Package(const std::string& name) : name(name), versions(new std::vector<Version>()) {}
+
+            ~Package() {
+                delete versions.load(std::memory_order_relaxed);
+            }
+
+            const std::string name;
+            std::atomic<const std::vector<Version>*> versions;
+        };
+
+        // An open-addressing hash table of packages, which is only ever
+        // added to, and is replaced by a larger copy when it fills up.
+        struct Table {
+            explicit Table(size_t capacity) : capacity(capacity), slots(new std::atomic<Package*>[capacity]) {
+                for (size_t i = 0; i < capacity; ++i)
+                    slots[i].store(nullptr, std::memory_order_relaxed);
+            }
+
+            const size_t capacity;
+            std::unique_ptr<std::atomic<Package*>[]> slots;
+        };
+
+        std::atomic<Table*> table;
+        std::atomic<size_t> packageCount;
+        std::mutex writeMutex;
+        mutable detail::EpochDomain domain;
+
+        const Package* findPackage(const std::string& name) const {
+            const Table* current = table.load(std::memory_order_acquire);
+            size_t mask = current->capacity - 1;
+
+            for (size_t i = std::hash<std::string>()(name) & mask; ; i = (i + 1) & mask) {
+                const Package* package = current->slots[i].load(std::memory_order_acquire);
+                if (package == nullptr || package->name == name)
+                    return package;
+            }
+        }
+
+        Package* findOrAddPackage(const std::string& name) {
+            Table* current = table.load(std::memory_order_relaxed);
+            if (Package* package = const_cast<Package*>(findPackage(name)))
+                return package;
+
+            // Keep the table at most half full, so that probes are short.
+            if ((packageCount.load(std::memory_order_relaxed) + 1) * 2 > current->capacity) {
+                Table* larger = new Table(current->capacity * 2);
+                for (size_t i = 0; i < current->capacity; ++i) {
+                    if (Package* package = current->slots[i].load(std::memory_order_relaxed))
+                        insert(*larger, package);
+                }
+
+                table.store(larger, std::memory_order_release);
+                domain.retire(current);
+                current = larger;
+            }
+
+            Package* package = new Package(name);
+            insert(*current, package);
+            packageCount.store(packageCount.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+            return package;
+        }
+
+        static void insert(Table& into, Package* package) {
+            size_t mask = into.capacity - 1;
+            size_t i = std::hash<std::string>()(package->name) & mask;
+            while (into.slots[i].load(std::memory_order_relaxed) != nullptr)
+                i = (i + 1) & mask;
+
+            into.slots[i].store(package, std::memory_order_release);
+        }
+
+        // Merge the sorted new versions in [start, end) into a copy of the
+        // sorted existing versions, without sorting them again.
+        static const std::vector<Version>* merge(const std::vector<Version>& existing,
+                                                 const std::vector<std::pair<const std::string*, Version>>& entries,
+                                                 size_t start,
+                                                 size_t end) {
+            std::unique_ptr<std::vector<Version>> merged(new std::vector<Version>());
+            merged->reserve(existing.size() + (end - start));
+
+            std::vector<Version>::const_iterator it = existing.begin();
+            for (size_t i = start; i < end; ++i) {
+                const Version& version = entries[i].second;
+                while (it != existing.end() && !(version < *it))
+                    merged->push_back(*it++);
+
+                // Skip exact duplicates, which are equivalent so must be
+                // among the versions just copied or just added.
+                bool isDuplicate = false;
+                for (size_t j = merged->size(); j > 0 && (*merged)[j - 1].compare(version) == 0; --j) {
+                    if ((*merged)[j - 1].str() == version.str()) {
+                        isDuplicate = true;
+                        break;
+                    }
+                }
+
+                if (!isDuplicate)
+                    merged->push_back(version);
+            }
+
+            merged->insert(merged->end(), it, existing.end());
+            return merged.release();
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,374 @@
+#ifndef PSEUDOSEM_CONSTRAINT
+#define PSEUDOSEM_CONSTRAINT
+
+#include "../pseudosem.h"
+
+#include <cctype>
+#include <stdexcept>
+#include <vector>
+
+namespace pseudosem {
+    namespace detail {
+        // Split a string on runs of whitespace.
+        inline std::vector<std::string> splitWords(const std::string& str) {
+            std::vector<std::string> words;
+            size_t start = 0;
+
+            while (start < str.size()) {
+                while (start < str.size() && std::isspace(static_cast<unsigned char>(str[start])))
+                    ++start;
+
+                size_t end = start;
+                while (end < str.size() && !std::isspace(static_cast<unsigned char>(str[end])))
+                    ++end;
+
+                if (end != start)
+                    words.push_back(str.substr(start, end - start));
+
+                start = end;
+            }
+
+            return words;
+        }
+
+        // Get the release numbers at the start of a version string, as
+        // strings of digits.
+        inline std::vector<std::string> leadingReleaseNumbers(const std::string& ver) {
+            std::vector<std::string> numbers;
+            size_t pos = 0;
+
+            while (pos < ver.size() && isDigit(ver[pos])) {
+                size_t end = pos;
+                while (end < ver.size() && isDigit(ver[end]))
+                    ++end;
+
+                numbers.push_back(ver.substr(pos, end - pos));
+
+                if (end == ver.size() || ver[end] != '.')
+                    break;
+
+                pos = end + 1;
+            }
+
+            return numbers;
+        }
+
+        // Add one to a string of digits.
+        inline std::string incrementDigits(std::string digits) {
+            size_t i = digits.size();
+            while (i > 0 && digits[i - 1] == '9')
+                digits[--i] = '0';
+
+            if (i == 0)
+                digits.insert(digits.begin(), '1');
+            else
+                ++digits[i - 1];
+
+            return digits;
+        }
+
+        // Get the lowest version that has a greater release number at the
+        // given index than the given version, and the same release numbers
+        // before it.
+        inline std::string nextReleaseNumber(const std::vector<std::string>& numbers, size_t index) {
+            std::string ver;
+            for (size_t i = 0; i < index; ++i)
+                ver += numbers[i] + '.';
+
+            // A pre-release of 0 sorts before all other versions with the
+            // same release numbers.
+            return ver + incrementDigits(numbers[index]) + "-0";
+        }
+    }
+
+    // A continuous range of versions, which may be unbounded at either end.
+    struct Interval {
+        Interval() : hasLower(false), lowerInclusive(true), hasUpper(false), upperInclusive(true) {}
+
+        bool hasLower;
+        Version lower;
+        bool lowerInclusive;
+
+        bool hasUpper;
+        Version upper;
+        bool upperInclusive;
+
+        // Raise the lower bound to the given version, if it is higher.
+        void restrictLower(const Version& version, bool inclusive) {
+            int result = hasLower ? version.compare(lower) : 1;
+            if (result > 0 || (result == 0 && !inclusive)) {
+                hasLower = true;
+                lower = version;
+                lowerInclusive = inclusive;
+            }
+        }
+
+        // Lower the upper bound to the given version, if it is lower.
+        void restrictUpper(const Version& version, bool inclusive) {
+            int result = hasUpper ? version.compare(upper) : -1;
+            if (result < 0 || (result == 0 && !inclusive)) {
+                hasUpper = true;
+                upper = version;
+                upperInclusive = inclusive;
+            }
+        }
+
+        bool isEmpty() const {
+            if (!hasLower || !hasUpper)
+                return false;
+
+            int result = lower.compare(upper);
+            return result > 0 || (result == 0 && !(lowerInclusive && upperInclusive));
+        }
+
+        bool contains(const detail::VersionParts& parts) const {
+            if (hasLower) {
+                int result = parts.compare(lower.versionParts());
+                if (result < 0 || (result == 0 && !lowerInclusive))
+                    return false;
+            }
+
+            if (hasUpper) {
+                int result = parts.compare(upper.versionParts());
+                if (result > 0 || (result == 0 && !upperInclusive))
+                    return false;
+            }
+
+            return true;
+        }
+
+        bool contains(const Version& version) const {
+            return contains(version.versionParts());
+        }
+    };
+
+    // A version constraint, compiled from an expression such as
+    // ">=1.2.0 <2.0.0-0 || ~3.4". An expression is a list of comparator sets
+    // separated by "||", and a version satisfies it if it satisfies every
+    // comparator in any of the sets. Comparators in a set are separated by
+    // whitespace, and are one of:
+    //
+    // - "<V", "<=V", ">V", ">=V" or "=V", which compare against V using
+    //   pseudosem's precedence rules. A bare "V" is the same as "=V".
+    // - "~V", which allows changes after the second release number of V, or
+    //   after the first if V has only one, e.g. "~1.2.3" is
+    //   ">=1.2.3 <1.3-0".
+    // - "^V", which allows changes after the first non-zero release number
+    //   of V, e.g. "^1.2.3" is ">=1.2.3 <2-0" and "^0.2.3" is
+    //   ">=0.2.3 <0.3-0".
+    // - "V1 - V2", which is the same as ">=V1 <=V2".
+    // - "*", "x", "1.x", "1.x.x", "1.2.*" or "1.*.*", which allow any
+    //   version with the given release numbers. Wildcards can only be
+    //   followed by other wildcards, so "1.x.2" is invalid. With "~" or
+    //   "^", the wildcards are dropped, so "^1.2.x" is "^1.2".
+    //
+    // Unlike node-semver, a pre-release version satisfies a constraint if it
+    // is within its bounds, whatever the bounds' release numbers. Since
+    // whitespace separates comparators, versions in expressions can't
+    // contain spaces.
+    //
+    // The bounds are parsed once, so matching a version does not allocate
+    // memory beyond parsing that version.
+    class Constraint {
+    public:
+        explicit Constraint(const std::string& expression) {
+            size_t start = 0;
+            size_t end = 0;
+
+            do {
+                end = expression.find("||", start);
+                parseSet(expression.substr(start, end == std::string::npos ? end : end - start));
+                start = end + 2;
+            } while (end != std::string::npos);
+        }
+
+        bool matches(const Version& version) const {
+            return matches(version.versionParts());
+        }
+
+        bool matches(const char* ver, size_t length) const {
+            return matches(detail::VersionParts(ver, length));
+        }
+
+        bool matches(const std::string& ver) const {
+            return matches(ver.data(), ver.size());
+        }
+
+        bool matches(const char* ver) const {
+            return matches(ver, std::strlen(ver));
+        }
+
+#ifdef PSEUDOSEM_HAS_STRING_VIEW
+        bool matches(std::string_view ver) const {
+            return matches(ver.data(), ver.size());
+        }
+#endif
+
+        bool matches(const detail::VersionParts& parts) const {
+            for (const Interval& interval : alternatives) {
+                if (interval.contains(parts))
+                    return true;
+            }
+
+            return false;
+        }
+
+        // Copy the versions in the given range that satisfy this constraint
+        // to the output iterator. The elements may be Versions or version
+        // strings.
+        template<typename InputIt, typename OutputIt>
+        OutputIt filter(InputIt first, InputIt last, OutputIt out) const {
+            for (; first != last; ++first) {
+                if (matches(*first)) {
+                    *out = *first;
+                    ++out;
+                }
+            }
+
+            return out;
+        }
+
+        // The ranges of versions that satisfy this constraint, one per
+        // comparator set. A version satisfies the constraint if it is in
+        // any of them.
+        const std::vector<Interval>& intervals() const {
+            return alternatives;
+        }
+
+    private:
+        std::vector<Interval> alternatives;
+
+        void parseSet(const std::string& set) {
+            std::vector<std::string> words(detail::splitWords(set));
+            Interval interval;
+
+            for (size_t i = 0; i < words.size(); ++i) {
+                std::string op(operatorPrefix(words[i]));
+                std::string ver(words[i].substr(op.size()));
+
+                // Allow whitespace between an operator and its version.
+                if (ver.empty() && !op.empty()) {
+                    if (i + 1 == words.size()) {
+                        PSEUDOSEM_COUNT(exceptions, 1);
+                        throw std::invalid_argument("pseudosem: no version after operator in constraint \"" + set + "\"");
+                    }
+
+                    ver = words[++i];
+                }
+
+                // Check for a hyphen range.
+                if (op.empty() && i + 2 < words.size() && words[i + 1] == "-") {
+                    interval.restrictLower(Version(ver), true);
+                    interval.restrictUpper(Version(words[i + 2]), true);
+                    i += 2;
+                    continue;
+                }
+
+                addComparator(interval, op, ver);
+            }
+
+            alternatives.push_back(interval);
+        }
+
+        static std::string operatorPrefix(const std::string& word) {
+            const char* operators[] = { ">=", "<=", ">", "<", "=", "~", "^" };
+
+            for (const char* op : operators) {
+                if (word.compare(0, std::strlen(op), op) == 0)
+                    return op;
+            }
+
+            return std::string();
+        }
+
+        static void addComparator(Interval& interval, const std::string& op, std::string ver) {
+            size_t prefixEnd = wildcardPrefixEnd(ver);
+            if (prefixEnd != std::string::npos) {
+                if (!op.empty() && op != "=" && op != "~" && op != "^") {
+                    PSEUDOSEM_COUNT(exceptions, 1);
+                    throw std::invalid_argument("pseudosem: wildcards can't be used with \"" + op + "\"");
+                }
+
+                if (prefixEnd == 0)
+                    return;
+
+                // The release numbers before the wildcards stand in for the
+                // version, so "^1.2.x" is the same as "^1.2".
+                ver.erase(prefixEnd);
+
+                if (op.empty() || op == "=") {
+                    // Allow anything with the given release numbers.
+                    std::vector<std::string> numbers(releaseNumbers(ver));
+                    interval.restrictLower(Version(ver), true);
+                    interval.restrictUpper(Version(detail::nextReleaseNumber(numbers, numbers.size() - 1)), false);
+                    return;
+                }
+            }
+
+            if (op.empty() || op == "=") {
+                interval.restrictLower(Version(ver), true);
+                interval.restrictUpper(Version(ver), true);
+            }
+            else if (op == ">=")
+                interval.restrictLower(Version(ver), true);
+            else if (op == ">")
+                interval.restrictLower(Version(ver), false);
+            else if (op == "<=")
+                interval.restrictUpper(Version(ver), true);
+            else if (op == "<")
+                interval.restrictUpper(Version(ver), false);
+            else {
+                std::vector<std::string> numbers(releaseNumbers(ver));
+                size_t index = 0;
+
+                if (op == "~")
+                    index = std::min<size_t>(numbers.size() - 1, 1);
+                else {
+                    while (index + 1 < numbers.size() && numbers[index].find_first_not_of('0') == std::string::npos)
+                        ++index;
+                }
+
+                interval.restrictLower(Version(ver), true);
+                interval.restrictUpper(Version(detail::nextReleaseNumber(numbers, index)), false);
+            }
+        }
+
+        static bool isWildcard(const std::string& str) {
+            return str == "*" || str == "x" || str == "X";
+        }
+
+        // Return the length of the part of the version before its trailing
+        // wildcard components, e.g. 1 for "1.x.x", or npos if it has none.
+        // Wildcards can only be followed by other wildcards.
+        static size_t wildcardPrefixEnd(const std::string& ver) {
+            size_t prefixEnd = std::string::npos;
+            for (size_t start = 0; start <= ver.size(); ) {
+                size_t end = std::min(ver.find('.', start), ver.size());
+                bool wildcard = isWildcard(ver.substr(start, end - start));
+
+                if (wildcard && prefixEnd == std::string::npos)
+                    prefixEnd = start == 0 ? 0 : start - 1;
+                else if (!wildcard && prefixEnd != std::string::npos) {
+                    PSEUDOSEM_COUNT(exceptions, 1);
+                    throw std::invalid_argument("pseudosem: wildcards in \"" + ver + "\" must come after its release numbers");
+                }
+
+                start = end + 1;
+            }
+
+            return prefixEnd;
+        }
+
+        static std::vector<std::string> releaseNumbers(const std::string& ver) {
+            std::vector<std::string> numbers(detail::leadingReleaseNumbers(ver));
+            if (numbers.empty()) {
+                PSEUDOSEM_COUNT(exceptions, 1);
+                throw std::invalid_argument("pseudosem: \"" + ver + "\" has no release numbers");
+            }
+
+            return numbers;
+        }
+    };
+}
+
+#endif
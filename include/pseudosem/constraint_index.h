@@ -0,0 +1,314 @@
+#ifndef PSEUDOSEM_CONSTRAINT_INDEX
+#define PSEUDOSEM_CONSTRAINT_INDEX
+
+#include "constraint.h"
+
+#include <iterator>
+#include <memory>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+namespace pseudosem {
+    namespace detail {
+        // Compare the lower bounds of two intervals, where a missing bound is
+        // lowest, and an exclusive bound is higher than an inclusive bound
+        // at the same version.
+        inline int compareLowerBounds(const Interval& a, const Interval& b) {
+            if (!a.hasLower || !b.hasLower)
+                return a.hasLower == b.hasLower ? 0 : (a.hasLower ? 1 : -1);
+
+            int result = a.lower.compare(b.lower);
+            if (result != 0 || a.lowerInclusive == b.lowerInclusive)
+                return result;
+
+            return a.lowerInclusive ? -1 : 1;
+        }
+
+        // Compare the upper bounds of two intervals, where a missing bound is
+        // highest, and an inclusive bound is higher than an exclusive bound
+        // at the same version.
+        inline int compareUpperBounds(const Interval& a, const Interval& b) {
+            if (!a.hasUpper || !b.hasUpper)
+                return a.hasUpper == b.hasUpper ? 0 : (a.hasUpper ? -1 : 1);
+
+            int result = a.upper.compare(b.upper);
+            if (result != 0 || a.upperInclusive == b.upperInclusive)
+                return result;
+
+            return a.upperInclusive ? 1 : -1;
+        }
+
+        inline bool isBelowLowerBound(const VersionParts& parts, const Interval& interval) {
+            if (!interval.hasLower)
+                return false;
+
+            int result = parts.compare(interval.lower.versionParts());
+            return result < 0 || (result == 0 && !interval.lowerInclusive);
+        }
+
+        inline bool isAboveUpperBound(const VersionParts& parts, const Interval& interval) {
+            if (!interval.hasUpper)
+                return false;
+
+            int result = parts.compare(interval.upper.versionParts());
+            return result > 0 || (result == 0 && !interval.upperInclusive);
+        }
+
+        // Merge overlapping intervals and remove empty ones, so that a
+        // version is in at most one of the returned intervals.
+        inline std::vector<Interval> disjointIntervals(std::vector<Interval> intervals) {
+            intervals.erase(std::remove_if(intervals.begin(), intervals.end(), [](const Interval& interval) {
+                return interval.isEmpty();
+            }), intervals.end());
+
+            std::sort(intervals.begin(), intervals.end(), [](const Interval& a, const Interval& b) {
+                return compareLowerBounds(a, b) < 0;
+            });
+
+            std::vector<Interval> merged;
+            for (const Interval& interval : intervals) {
+                if (!merged.empty()) {
+                    Interval& last = merged.back();
+                    bool overlaps = !last.hasUpper || !interval.hasLower;
+
+                    if (!overlaps) {
+                        int result = interval.lower.compare(last.upper);
+                        overlaps = result < 0 || (result == 0 && (interval.lowerInclusive || last.upperInclusive));
+                    }
+
+                    if (overlaps) {
+                        if (compareUpperBounds(interval, last) > 0) {
+                            last.hasUpper = interval.hasUpper;
+                            last.upper = interval.upper;
+                            last.upperInclusive = interval.upperInclusive;
+                        }
+                        continue;
+                    }
+                }
+
+                merged.push_back(interval);
+            }
+
+            return merged;
+        }
+    }
+
+    // An index of the intervals of many constraints, each identified by a
+    // caller-supplied ID, that can find which constraints a version
+    // satisfies without checking each one. A search takes expected
+    // O(log n) time with no matches, and O(k log n) for k matches, since
+    // each match can need its own path down the tree.
+    //
+    // The index is a treap of intervals ordered by their lower bounds, where
+    // each node also records the highest upper bound in its subtree, so that
+    // searches can skip subtrees that can't contain a version.
+    class ConstraintIndex {
+    public:
+        typedef size_t Id;
+
+        ConstraintIndex() : random(0) {}
+
+        // Add a constraint to the index. If the ID is already in the index,
+        // the constraint is added to those it identifies, so a version
+        // satisfying either will match it. A constraint that no version
+        // satisfies isn't added, and doesn't count towards size().
+        void insert(Id id, const Constraint& constraint) {
+            std::vector<Interval> intervals(constraint.intervals());
+
+            auto existing = nodesById.find(id);
+            if (existing != nodesById.end()) {
+                for (Node* node : existing->second)
+                    intervals.push_back(node->interval);
+            }
+
+            // Intervals with the same ID mustn't overlap, so that the ID is
+            // found at most once for a version.
+            intervals = detail::disjointIntervals(intervals);
+            if (intervals.empty())
+                return;
+
+            std::vector<Node*>& nodes = nodesById[id];
+            removeNodes(id);
+            for (Interval& interval : intervals) {
+                std::unique_ptr<Node> node(new Node(id, std::move(interval), random()));
+                nodes.push_back(node.get());
+                root = insert(std::move(root), std::move(node));
+            }
+        }
+
+        // Remove the constraints with the given ID from the index, returning
+        // true if there were any.
+        bool remove(Id id) {
+            auto it = nodesById.find(id);
+            if (it == nodesById.end())
+                return false;
+
+            removeNodes(id);
+            nodesById.erase(it);
+            return true;
+        }
+
+        // Write the IDs of the constraints that the version satisfies to the
+        // output iterator. Each ID is written at most once, in no particular
+        // order.
+        template<typename OutputIt>
+        OutputIt find(const Version& version, OutputIt out) const {
+            return find(root.get(), version.versionParts(), out);
+        }
+
+        template<typename OutputIt>
+        OutputIt find(const std::string& ver, OutputIt out) const {
+            return find(root.get(), detail::VersionParts(ver), out);
+        }
+
+        std::vector<Id> find(const Version& version) const {
+            std::vector<Id> ids;
+            find(version, std::back_inserter(ids));
+            return ids;
+        }
+
+        std::vector<Id> find(const std::string& ver) const {
+            std::vector<Id> ids;
+            find(ver, std::back_inserter(ids));
+            return ids;
+        }
+
+        // The number of IDs in the index.
+        size_t size() const {
+            return nodesById.size();
+        }
+
+    private:
+        struct Node {
+            Node(Id id, Interval interval, unsigned priority) :
+                id(id), interval(std::move(interval)), priority(priority), maxUpper(&this->interval) {}
+
+            Id id;
+            Interval interval;
+            unsigned priority;
+
+            // The interval in this subtree with the highest upper bound.
+            const Interval* maxUpper;
+
+            std::unique_ptr<Node> left;
+            std::unique_ptr<Node> right;
+
+            void update() {
+                maxUpper = &interval;
+                if (left && detail::compareUpperBounds(*left->maxUpper, *maxUpper) > 0)
+                    maxUpper = left->maxUpper;
+                if (right && detail::compareUpperBounds(*right->maxUpper, *maxUpper) > 0)
+                    maxUpper = right->maxUpper;
+            }
+
+            bool isBefore(const Node& other) const {
+                int result = detail::compareLowerBounds(interval, other.interval);
+                return result < 0 || (result == 0 && id < other.id);
+            }
+        };
+
+        std::unique_ptr<Node> root;
+        std::unordered_map<Id, std::vector<Node*>> nodesById;
+        std::minstd_rand random;
+
+        void removeNodes(Id id) {
+            std::vector<Node*>& nodes = nodesById[id];
+            for (Node* node : nodes)
+                root = erase(std::move(root), *node);
+            nodes.clear();
+        }
+
+        static std::unique_ptr<Node> insert(std::unique_ptr<Node> tree, std::unique_ptr<Node> node) {
+            if (!tree)
+                return node;
+
+            if (node->priority > tree->priority) {
+                split(std::move(tree), *node, node->left, node->right);
+                node->update();
+                return node;
+            }
+
+            if (node->isBefore(*tree))
+                tree->left = insert(std::move(tree->left), std::move(node));
+            else
+                tree->right = insert(std::move(tree->right), std::move(node));
+
+            tree->update();
+            return tree;
+        }
+
+        // Erase the given node from the tree, destroying it.
+        static std::unique_ptr<Node> erase(std::unique_ptr<Node> tree, const Node& node) {
+            if (tree.get() == &node)
+                return merge(std::move(tree->left), std::move(tree->right));
+
+            if (node.isBefore(*tree))
+                tree->left = erase(std::move(tree->left), node);
+            else
+                tree->right = erase(std::move(tree->right), node);
+
+            tree->update();
+            return tree;
+        }
+
+        // Split a tree into nodes before the given node and nodes after it.
+        static void split(std::unique_ptr<Node> tree,
+                          const Node& node,
+                          std::unique_ptr<Node>& before,
+                          std::unique_ptr<Node>& after) {
+            if (!tree)
+                return;
+
+            if (tree->isBefore(node)) {
+                split(std::move(tree->right), node, tree->right, after);
+                tree->update();
+                before = std::move(tree);
+            }
+            else {
+                split(std::move(tree->left), node, before, tree->left);
+                tree->update();
+                after = std::move(tree);
+            }
+        }
+
+        static std::unique_ptr<Node> merge(std::unique_ptr<Node> before, std::unique_ptr<Node> after) {
+            if (!before)
+                return after;
+            if (!after)
+                return before;
+
+            if (before->priority > after->priority) {
+                before->right = merge(std::move(before->right), std::move(after));
+                before->update();
+                return before;
+            }
+
+            after->left = merge(std::move(before), std::move(after->left));
+            after->update();
+            return after;
+        }
+
+        template<typename OutputIt>
+        static OutputIt find(const Node* node, const detail::VersionParts& parts, OutputIt out) {
+            while (node && !detail::isAboveUpperBound(parts, *node->maxUpper)) {
+                out = find(node->left.get(), parts, out);
+
+                // Nodes to the right have lower bounds at least as high.
+                if (detail::isBelowLowerBound(parts, node->interval))
+                    break;
+
+                if (!detail::isAboveUpperBound(parts, node->interval)) {
+                    *out = node->id;
+                    ++out;
+                }
+
+                node = node->right.get();
+            }
+
+            return out;
+        }
+    };
+}
+
+#endif
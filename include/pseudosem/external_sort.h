@@ -0,0 +1,284 @@
+#ifndef PSEUDOSEM_EXTERNAL_SORT
+#define PSEUDOSEM_EXTERNAL_SORT
+
+#include "sort.h"
+
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pseudosem {
+    namespace detail {
+        // A sorted run of versions, one per line, in a temporary file that
+        // is deleted when it is closed.
+        class RunFile {
+        public:
+            RunFile() : file(std::tmpfile()), buffer(1 << 16), position(0), buffered(0) {
+                if (file == nullptr)
+                    fail("can't create a temporary file");
+            }
+
+            ~RunFile() {
+                std::fclose(file);
+            }
+
+            void write(const char* ver, size_t length) {
+                if (std::fwrite(ver, 1, length, file) != length || std::fputc('\n', file) == EOF)
+                    fail("can't write to a temporary file");
+            }
+
+            // Start reading the lines that have been written.
+            void rewind() {
+                if (std::fflush(file) != 0)
+                    fail("can't write to a temporary file");
+
+                std::rewind(file);
+                position = 0;
+                buffered = 0;
+            }
+
+            bool readLine(std::string& line) {
+                line.clear();
+
+                while (true) {
+                    if (position == buffered) {
+                        buffered = std::fread(&buffer[0], 1, buffer.size(), file);
+                        position = 0;
+
+                        if (buffered == 0) {
+                            if (std::ferror(file))
+                                fail("can't read a temporary file");
+
+                            return !line.empty();
+                        }
+                    }
+
+                    const char* start = &buffer[position];
+                    const char* newline = static_cast<const char*>(std::memchr(start, '\n', buffered - position));
+                    if (newline != nullptr) {
+                        line.append(start, newline);
+                        position += newline - start + 1;
+                        return true;
+                    }
+
+                    line.append(start, buffered - position);
+                    position = buffered;
+                }
+            }
+
+        private:
+            std::FILE* file;
+            std::vector<char> buffer;
+            size_t position;
+            size_t buffered;
+
+            RunFile(const RunFile&) = delete;
+            RunFile& operator=(const RunFile&) = delete;
+
+            static void fail(const char* message) {
+                PSEUDOSEM_COUNT(exceptions, 1);
+                throw std::runtime_error(std::string("pseudosem: ") + message);
+            }
+        };
+    }
+
+    // Sorts more versions than fit in memory. Versions are added to an
+    // in-memory chunk until it would exceed the memory budget, then the
+    // chunk is sorted, parsing each version once, and written to a
+    // temporary file as a sorted run. write() merges the runs with a heap.
+    //
+    // The sort is stable: equivalent versions are written in the order they
+    // were added, and if unique is true, only the first of them is written.
+    // Runs are merged in groups of up to maxMergeWidth as they accumulate,
+    // so the number of open files stays small however many versions there
+    // are. It can be used with reduce() to sort a stream of versions.
+    class ExternalSorter {
+    public:
+        // The budget is roughly the bytes of memory to use for the versions
+        // in a chunk and their parsed parts. Chunks are sorted on up to
+        // threads threads, or one per hardware thread if threads is 0.
+        explicit ExternalSorter(size_t memoryBudget = 64 << 20, bool unique = false, unsigned threads = 0)
+            : memoryBudget(memoryBudget), unique(unique), threads(threads), chunkMemory(0) {}
+
+        // Add a version. Runs hold one version per line, so versions can't
+        // contain newlines.
+        void add(const char* ver, size_t length) {
+            if (std::memchr(ver, '\n', length) != nullptr) {
+                PSEUDOSEM_COUNT(exceptions, 1);
+                throw std::invalid_argument("pseudosem: versions in an external sort can't contain newlines");
+            }
+
+            size_t memory = length + sizeof(Record) + sizeof(detail::VersionParts) + sizeof(size_t);
+            if (!records.empty() && chunkMemory + memory > memoryBudget)
+                spill();
+
+            records.push_back(Record{ text.size(), length });
+            text.append(ver, length);
+            chunkMemory += memory;
+        }
+
+        void add(const std::string& ver) {
+            add(ver.data(), ver.size());
+        }
+
+        // Write the sorted versions to the stream, one per line, and return
+        // how many were written. The sorter is empty afterwards.
+        size_t write(std::ostream& out) {
+            auto output = [&out](const char* ver, size_t length) {
+                out.write(ver, length);
+                out.put('\n');
+            };
+
+            if (runs.empty()) {
+                size_t written = sortChunk(output);
+                clearChunk();
+                return written;
+            }
+
+            if (!records.empty())
+                spill();
+
+            std::vector<Run> allRuns;
+            allRuns.swap(runs);
+            return merge(allRuns, output);
+        }
+
+        // The number of sorted runs written to temporary files so far.
+        size_t spilledRuns() const {
+            return runs.size();
+        }
+
+    private:
+        static const size_t maxMergeWidth = 64;
+
+        struct Record {
+            size_t offset;
+            size_t length;
+        };
+
+        // A run made by merging maxMergeWidth runs of the level below, or by
+        // sorting a chunk for level 0.
+        struct Run {
+            std::unique_ptr<detail::RunFile> file;
+            size_t level;
+        };
+
+        size_t memoryBudget;
+        bool unique;
+        unsigned threads;
+        std::string text;
+        std::vector<Record> records;
+        size_t chunkMemory;
+        std::vector<Run> runs;
+
+        void clearChunk() {
+            text.clear();
+            records.clear();
+            chunkMemory = 0;
+        }
+
+        // Sort the chunk and pass each of its versions to output.
+        template<typename Output>
+        size_t sortChunk(Output output) {
+            size_t count = records.size();
+            std::vector<detail::VersionParts> parts(count);
+            size_t parseThreads = detail::threadCount(threads, count, 1024);
+            detail::parallelFor(parseThreads, [&](size_t i) {
+                for (size_t j = i * count / parseThreads; j < (i + 1) * count / parseThreads; ++j)
+                    parts[j].assign(text.data() + records[j].offset, records[j].length);
+            });
+
+            std::vector<size_t> order(detail::sortedOrder(parts, detail::threadCount(threads, count, 4096)));
+
+            size_t written = 0;
+            for (size_t i = 0; i < order.size(); ++i) {
+                if (unique && i > 0 && parts[order[i]].compare(parts[order[i - 1]]) == 0)
+                    continue;
+
+                const Record& record = records[order[i]];
+                output(text.data() + record.offset, record.length);
+                ++written;
+            }
+
+            return written;
+        }
+
+        void spill() {
+            std::unique_ptr<detail::RunFile> file(new detail::RunFile());
+            sortChunk([&file](const char* ver, size_t length) { file->write(ver, length); });
+            file->rewind();
+            clearChunk();
+
+            runs.push_back(Run{ std::move(file), 0 });
+
+            // Merging adjacent runs keeps equivalent versions in the order
+            // they were added.
+            while (runs.size() >= maxMergeWidth && runs[runs.size() - maxMergeWidth].level == runs.back().level) {
+                std::vector<Run> group;
+                for (size_t i = runs.size() - maxMergeWidth; i < runs.size(); ++i)
+                    group.push_back(std::move(runs[i]));
+                runs.resize(runs.size() - maxMergeWidth);
+
+                std::unique_ptr<detail::RunFile> merged(new detail::RunFile());
+                merge(group, [&merged](const char* ver, size_t length) { merged->write(ver, length); });
+                merged->rewind();
+
+                runs.push_back(Run{ std::move(merged), group.back().level + 1 });
+            }
+        }
+
+        // Merge the runs, taking equivalent versions from earlier runs
+        // first, and pass each version to output.
+        template<typename Output>
+        size_t merge(std::vector<Run>& group, Output output) {
+            std::vector<Version> heads(group.size());
+            std::vector<size_t> heap;
+            std::string line;
+
+            for (size_t i = 0; i < group.size(); ++i) {
+                if (group[i].file->readLine(line)) {
+                    heads[i].assign(line);
+                    heap.push_back(i);
+                }
+            }
+
+            auto later = [&heads](size_t a, size_t b) {
+                int result = heads[a].compare(heads[b]);
+                return result > 0 || (result == 0 && a > b);
+            };
+            std::make_heap(heap.begin(), heap.end(), later);
+
+            Version last;
+            size_t written = 0;
+            while (!heap.empty()) {
+                std::pop_heap(heap.begin(), heap.end(), later);
+                size_t run = heap.back();
+
+                if (!unique || written == 0 || heads[run].compare(last) != 0) {
+                    output(heads[run].str().data(), heads[run].str().size());
+                    ++written;
+
+                    // The head is about to be replaced, so take its memory
+                    // instead of copying it.
+                    if (unique)
+                        std::swap(last, heads[run]);
+                }
+
+                if (group[run].file->readLine(line)) {
+                    heads[run].assign(line);
+                    std::push_heap(heap.begin(), heap.end(), later);
+                }
+                else
+                    heap.pop_back();
+            }
+
+            return written;
+        }
+    };
+}
+
+#endif
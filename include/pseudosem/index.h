@@ -0,0 +1,606 @@
+#ifndef PSEUDOSEM_INDEX
+#define PSEUDOSEM_INDEX
+
+#include "sort.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace pseudosem {
+    namespace detail {
+        inline void failIndex(const std::string& message) {
+            PSEUDOSEM_COUNT(exceptions, 1);
+            throw std::runtime_error("pseudosem: " + message);
+        }
+
+        // The layout of an index file: a header, then the rows in version
+        // order, then the release numbers of all rows, then their release
+        // and pre-release strings, then the text of the versions. Integers
+        // are in the byte order of the machine that wrote the file, and
+        // every section starts on an 8-byte boundary, so the sections can
+        // be read in place from a mapping of the file.
+        static const char indexMagic[8] = { 'p', 's', 'e', 'm', 'i', 'd', 'x', '\n' };
+        static const uint32_t indexFormatVersion = 1;
+        static const uint32_t indexByteOrder = 0x01020304;
+
+        struct IndexHeader {
+            char magic[8];
+            uint32_t formatVersion;
+            uint32_t byteOrder;
+            uint64_t rowCount;
+            uint64_t numberCount;
+            uint64_t stringCount;
+            uint64_t textSize;
+            uint64_t reserved[2];
+        };
+
+        // Release numbers don't include trailing zeroes, and pre-release
+        // strings follow release strings, as in a VersionTable.
+        struct IndexRow {
+            uint64_t textOffset;
+            uint64_t firstNumber;
+            uint64_t firstString;
+            uint32_t length;
+            uint32_t numberCount;
+            uint32_t releaseStringCount;
+            uint32_t preReleaseStringCount;
+        };
+
+        // Offsets of digits and strings are from the start of their row's
+        // text.
+        struct IndexNumber {
+            uint64_t value;
+            uint32_t digitsOffset;
+            uint32_t digitsLength;
+        };
+
+        struct IndexString {
+            uint32_t offset;
+            uint32_t length;
+        };
+
+        static_assert(sizeof(IndexHeader) == 64 && sizeof(IndexRow) == 40 && sizeof(IndexNumber) == 16 && sizeof(IndexString) == 8,
+                      "Index records must have the same layout on every platform");
+
+        // A list of a row's strings for compareTokens().
+        struct IndexStrings {
+            const IndexString* strings;
+            size_t count;
+            const char* text;
+
+            size_t size() const { return count; }
+            Token operator[](size_t i) const { return Token{ text + strings[i].offset, strings[i].length }; }
+        };
+
+        // A read-only mapping of a whole file into memory.
+        class MappedFile {
+        public:
+            explicit MappedFile(const std::string& path) : address(nullptr), length(0) {
+#ifdef _WIN32
+                HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+                                          OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+                if (file == INVALID_HANDLE_VALUE)
+                    failIndex("can't open " + path);
+
+                LARGE_INTEGER size;
+                HANDLE mapping = nullptr;
+                if (GetFileSizeEx(file, &size) && size.QuadPart > 0)
+                    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                CloseHandle(file);
+
+                if (mapping != nullptr) {
+                    address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                    CloseHandle(mapping);
+                }
+
+                if (address == nullptr)
+                    failIndex("can't map " + path);
+
+                length = static_cast<size_t>(size.QuadPart);
+#else
+                int file = ::open(path.c_str(), O_RDONLY);
+                if (file < 0)
+                    failIndex("can't open " + path);
+
+                struct stat status;
+                if (::fstat(file, &status) == 0 && status.st_size > 0) {
+                    length = static_cast<size_t>(status.st_size);
+                    address = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, file, 0);
+                    if (address == MAP_FAILED)
+                        address = nullptr;
+                }
+                ::close(file);
+
+                if (address == nullptr)
+                    failIndex("can't map " + path);
+#endif
+            }
+
+            ~MappedFile() {
+#ifdef _WIN32
+                UnmapViewOfFile(address);
+#else
+                ::munmap(address, length);
+#endif
+            }
+
+            const char* data() const {
+                return static_cast<const char*>(address);
+            }
+
+            size_t size() const {
+                return length;
+            }
+
+        private:
+            void* address;
+            size_t length;
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+        };
+
+        // Replace a file with another, atomically where the platform allows.
+        inline void replaceFile(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+            bool replaced = MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+            bool replaced = std::rename(from.c_str(), to.c_str()) == 0;
+#endif
+            if (!replaced) {
+                std::remove(from.c_str());
+                failIndex("can't replace " + to);
+            }
+        }
+
+        // Builds an index from versions that are added in version order,
+        // and writes it to a file.
+        class IndexWriter {
+        public:
+            void add(const char* ver, size_t length, const VersionParts& parts) {
+                const VersionParts::Tokens& releaseStrings = parts.releaseTokens();
+                const VersionParts::Tokens& preReleaseStrings = parts.preReleaseTokens();
+                size_t numberCount = parts.significantReleaseNumbers();
+
+                if (length > std::numeric_limits<uint32_t>::max()) {
+                    PSEUDOSEM_COUNT(exceptions, 1);
+                    throw std::length_error("pseudosem: version is too long for an index");
+                }
+
+                IndexRow row;
+                row.textOffset = text.size();
+                row.firstNumber = numbers.size();
+                row.firstString = strings.size();
+                row.length = static_cast<uint32_t>(length);
+                row.numberCount = static_cast<uint32_t>(numberCount);
+                row.releaseStringCount = static_cast<uint32_t>(releaseStrings.size());
+                row.preReleaseStringCount = static_cast<uint32_t>(preReleaseStrings.size());
+                rows.push_back(row);
+
+                for (size_t i = 0; i < numberCount; ++i) {
+                    const Number& number = parts.numbers()[i];
+                    IndexString digits = offsetOf(number.digits, ver);
+                    numbers.push_back(IndexNumber{ number.value, digits.offset, digits.length });
+                }
+
+                for (const Token& token : releaseStrings)
+                    strings.push_back(offsetOf(token, ver));
+                for (const Token& token : preReleaseStrings)
+                    strings.push_back(offsetOf(token, ver));
+
+                text.append(ver, length);
+            }
+
+            // Write the index to a temporary file next to the path, then
+            // replace the file at the path with it, so that readers never
+            // see a partly written index.
+            void write(const std::string& path) {
+                std::string temporaryPath(path + ".tmp");
+                std::FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+                if (file == nullptr)
+                    failIndex("can't create " + temporaryPath);
+
+                IndexHeader header = IndexHeader();
+                std::memcpy(header.magic, indexMagic, sizeof(indexMagic));
+                header.formatVersion = indexFormatVersion;
+                header.byteOrder = indexByteOrder;
+                header.rowCount = rows.size();
+                header.numberCount = numbers.size();
+                header.stringCount = strings.size();
+                header.textSize = text.size();
+
+                bool written = writeAll(file, &header, sizeof(header), 1) &&
+                               writeAll(file, rows.data(), sizeof(IndexRow), rows.size()) &&
+                               writeAll(file, numbers.data(), sizeof(IndexNumber), numbers.size()) &&
+                               writeAll(file, strings.data(), sizeof(IndexString), strings.size()) &&
+                               writeAll(file, text.data(), 1, text.size());
+
+                if (std::fclose(file) != 0 || !written) {
+                    std::remove(temporaryPath.c_str());
+                    failIndex("can't write " + temporaryPath);
+                }
+
+                replaceFile(temporaryPath, path);
+            }
+
+        private:
+            std::vector<IndexRow> rows;
+            std::vector<IndexNumber> numbers;
+            std::vector<IndexString> strings;
+            std::string text;
+
+            static IndexString offsetOf(const Token& token, const char* ver) {
+                if (token.data == nullptr)
+                    return IndexString{ 0, 0 };
+
+                return IndexString{ static_cast<uint32_t>(token.data - ver), static_cast<uint32_t>(token.size) };
+            }
+
+            static bool writeAll(std::FILE* file, const void* data, size_t size, size_t count) {
+                return count == 0 || std::fwrite(data, size, count, file) == count;
+            }
+        };
+    }
+
+    // A sorted list of versions persisted in a file that is mapped into
+    // memory, so that a process can open it without reading or sorting the
+    // versions, and search and scan it without copying them. The file holds
+    // the versions in order with their parsed parts, in the same columns as
+    // a VersionTable, and is only validated as a whole when it is opened.
+    //
+    // Versions appended to an open index go to a small delta segment, kept
+    // sorted in memory and appended to a text file next to the index, one
+    // version per line. When the delta grows past its maximum size, it is
+    // merged with the index into a new index file, which replaces the old
+    // one. Versions that the index already has, with exactly the same
+    // string, are ignored, so a delta that was merged but not yet removed
+    // when a process stopped is harmless.
+    //
+    // Const members can be called from any number of threads at once, but
+    // appending and merging need exclusive access, and only one process at
+    // a time may append to an index.
+    class VersionIndex {
+    public:
+        // Write an index of the versions to the path, replacing any index
+        // and delta that are already there.
+        static void write(const std::string& path, const std::vector<std::string>& versions, size_t threads = 1) {
+            std::vector<detail::VersionParts> parts(versions.size());
+            for (size_t i = 0; i < versions.size(); ++i)
+                parts[i].assign(versions[i].data(), versions[i].size());
+
+            detail::IndexWriter writer;
+            for (size_t i : detail::sortedOrder(parts, detail::threadCount(threads, parts.size(), 4096)))
+                writer.add(versions[i].data(), versions[i].size(), parts[i]);
+
+            writer.write(path);
+            std::remove(deltaPath(path).c_str());
+        }
+
+        // Open the index at the path, and its delta if it has one. An empty
+        // index is created if there is no file at the path, keeping any
+        // delta that is there. Throws if the file exists but can't be
+        // opened.
+        explicit VersionIndex(const std::string& path, size_t maxDeltaSize = 4096)
+            : path(path), maxDeltaSize(maxDeltaSize), deltaFile(nullptr) {
+            errno = 0;
+            if (std::FILE* existing = std::fopen(path.c_str(), "rb"))
+                std::fclose(existing);
+            else if (errno == ENOENT)
+                detail::IndexWriter().write(path);
+            else {
+                // Any other failure, like a lack of permission, mustn't
+                // replace an index that is there.
+                detail::failIndex("can't open " + path);
+            }
+
+            map();
+
+            std::ifstream in(deltaPath(path).c_str(), std::ios::binary);
+            std::string line;
+            while (std::getline(in, line))
+                addToDelta(line);
+        }
+
+        ~VersionIndex() {
+            if (deltaFile != nullptr)
+                std::fclose(deltaFile);
+        }
+
+        VersionIndex(const VersionIndex&) = delete;
+        VersionIndex& operator=(const VersionIndex&) = delete;
+
+        // The number of versions, including those in the delta.
+        size_t size() const {
+            return rowCount + delta.size();
+        }
+
+        bool empty() const {
+            return size() == 0;
+        }
+
+        // The number of versions in the delta.
+        size_t deltaSize() const {
+            return delta.size();
+        }
+
+        // Add a version, and return false if the index already has it. The
+        // delta is merged into the index if this makes it too large.
+        bool append(const std::string& ver) {
+            if (ver.find('\n') != std::string::npos) {
+                PSEUDOSEM_COUNT(exceptions, 1);
+                throw std::invalid_argument("pseudosem: versions in an index can't contain newlines");
+            }
+
+            if (!addToDelta(ver))
+                return false;
+
+            if (deltaFile == nullptr)
+                deltaFile = std::fopen(deltaPath(path).c_str(), "ab");
+
+            if (deltaFile == nullptr ||
+                std::fwrite(ver.data(), 1, ver.size(), deltaFile) != ver.size() ||
+                std::fputc('\n', deltaFile) == EOF ||
+                std::fflush(deltaFile) != 0)
+                detail::failIndex("can't write " + deltaPath(path));
+
+            if (delta.size() > maxDeltaSize)
+                merge();
+
+            return true;
+        }
+
+        // Write a new index file with the versions in the delta merged in,
+        // and start a new delta.
+        void merge() {
+            if (delta.empty())
+                return;
+
+            detail::IndexWriter writer;
+            detail::VersionParts parts;
+            scan([&writer, &parts](const char* ver, size_t length) {
+                parts.assign(ver, length);
+                writer.add(ver, length, parts);
+            });
+
+            try {
+#ifdef _WIN32
+                // A file can't be replaced while it is mapped.
+                mapping.reset();
+#endif
+                writer.write(path);
+            }
+            catch (...) {
+                map();
+                throw;
+            }
+
+            map();
+
+            if (deltaFile != nullptr) {
+                std::fclose(deltaFile);
+                deltaFile = nullptr;
+            }
+
+            std::remove(deltaPath(path).c_str());
+            delta.clear();
+        }
+
+        // Call f(ver, length) for each version in order, with equivalent
+        // versions in the order they were added. The strings of versions
+        // that aren't in the delta point into the mapped file.
+        template<typename Function>
+        void scan(Function f) const {
+            scan(0, rowCount, delta.begin(), delta.end(), f);
+        }
+
+        // Call f(ver, length) for each version that is neither earlier than
+        // lower nor later than upper, in order.
+        template<typename Function>
+        void scan(const Version& lower, const Version& upper, Function f) const {
+            scan(lowerBound(lower), upperBound(upper),
+                 std::lower_bound(delta.begin(), delta.end(), lower), std::upper_bound(delta.begin(), delta.end(), upper), f);
+        }
+
+        // The first of the latest versions, or an empty string if there are
+        // none.
+        std::string latest() const {
+            // Versions in the delta were added after equivalent rows.
+            if (delta.empty() || (rowCount > 0 && compare(rowCount - 1, delta.back().versionParts()) >= 0)) {
+                if (rowCount == 0)
+                    return std::string();
+
+                return rowString(lowerBound(Version(rowString(rowCount - 1).str()))).str();
+            }
+
+            return std::lower_bound(delta.begin(), delta.end(), delta.back())->str();
+        }
+
+    private:
+        typedef std::vector<Version>::const_iterator DeltaIterator;
+
+        std::string path;
+        size_t maxDeltaSize;
+        std::unique_ptr<detail::MappedFile> mapping;
+        const detail::IndexRow* rows;
+        const detail::IndexNumber* numbers;
+        const detail::IndexString* strings;
+        const char* text;
+        size_t rowCount;
+        std::vector<Version> delta;
+        std::FILE* deltaFile;
+
+        static std::string deltaPath(const std::string& path) {
+            return path + ".delta";
+        }
+
+        // Map the index file and check that its sections fit it exactly.
+        void map() {
+            mapping.reset(new detail::MappedFile(path));
+            const char* data = mapping->data();
+            size_t size = mapping->size();
+
+            detail::IndexHeader header;
+            if (size < sizeof(header))
+                detail::failIndex(path + " isn't a version index");
+
+            std::memcpy(&header, data, sizeof(header));
+            if (std::memcmp(header.magic, detail::indexMagic, sizeof(header.magic)) != 0)
+                detail::failIndex(path + " isn't a version index");
+            if (header.formatVersion != detail::indexFormatVersion)
+                detail::failIndex(path + " has an unsupported index format version");
+            if (header.byteOrder != detail::indexByteOrder)
+                detail::failIndex(path + " was written with a different byte order");
+
+            // Each count is checked against the size first, so that the
+            // sum can't overflow.
+            if (header.rowCount > size || header.numberCount > size || header.stringCount > size || header.textSize > size ||
+                sizeof(header) + header.rowCount * sizeof(detail::IndexRow) + header.numberCount * sizeof(detail::IndexNumber) +
+                    header.stringCount * sizeof(detail::IndexString) + header.textSize != size)
+                detail::failIndex(path + " is truncated or corrupt");
+
+            rowCount = static_cast<size_t>(header.rowCount);
+            rows = reinterpret_cast<const detail::IndexRow*>(data + sizeof(header));
+            numbers = reinterpret_cast<const detail::IndexNumber*>(rows + rowCount);
+            strings = reinterpret_cast<const detail::IndexString*>(numbers + header.numberCount);
+            text = reinterpret_cast<const char*>(strings + header.stringCount);
+        }
+
+        // Add a version to the delta after any equivalent versions, unless
+        // the index already has it.
+        bool addToDelta(const std::string& ver) {
+            Version version(ver);
+
+            for (size_t row = lowerBound(version); row < rowCount && compare(row, version.versionParts()) == 0; ++row) {
+                if (rowString(row).str() == ver)
+                    return false;
+            }
+
+            DeltaIterator first = std::lower_bound(delta.begin(), delta.end(), version);
+            DeltaIterator last = std::upper_bound(first, DeltaIterator(delta.end()), version);
+            for (DeltaIterator it = first; it != last; ++it) {
+                if (it->str() == ver)
+                    return false;
+            }
+
+            delta.insert(delta.begin() + (last - delta.begin()), std::move(version));
+            return true;
+        }
+
+        // A view of a row's string, without copying it.
+        struct RowString {
+            const char* data;
+            size_t length;
+
+            std::string str() const {
+                return std::string(data, length);
+            }
+        };
+
+        RowString rowString(size_t row) const {
+            return RowString{ text + rows[row].textOffset, rows[row].length };
+        }
+
+        // Compare a row with parsed parts in the same way as
+        // VersionParts::compare().
+        int compare(size_t index, const detail::VersionParts& parts) const {
+            const detail::IndexRow& row = rows[index];
+            const char* rowText = text + row.textOffset;
+
+            size_t numberCount = parts.significantReleaseNumbers();
+            size_t count = std::min<size_t>(row.numberCount, numberCount);
+            for (size_t i = 0; i < count; ++i) {
+                const detail::IndexNumber& number = numbers[row.firstNumber + i];
+                const detail::Number& otherNumber = parts.numbers()[i];
+
+                if (number.value != otherNumber.value)
+                    return number.value < otherNumber.value ? -1 : 1;
+
+                // Only numbers too long to have a value need a closer look.
+                if (number.value == detail::longNumber) {
+                    int result = detail::compareNumbers(detail::Token{ rowText + number.digitsOffset, number.digitsLength }, otherNumber.digits);
+                    if (result != 0)
+                        return result;
+                }
+            }
+
+            // Neither list of release numbers has trailing zeroes, so the
+            // longer one is later.
+            if (row.numberCount != numberCount)
+                return row.numberCount > numberCount ? 1 : -1;
+
+            const detail::IndexString* rowStrings = strings + row.firstString;
+            int result = detail::compareTokens(detail::IndexStrings{ rowStrings, row.releaseStringCount, rowText },
+                                               parts.releaseTokens(), true);
+            if (result != 0)
+                return result;
+
+            return detail::compareTokens(detail::IndexStrings{ rowStrings + row.releaseStringCount, row.preReleaseStringCount, rowText },
+                                         parts.preReleaseTokens(), false);
+        }
+
+        // The first row that isn't earlier than the version.
+        size_t lowerBound(const Version& version) const {
+            return partitionPoint([this, &version](size_t row) { return compare(row, version.versionParts()) < 0; });
+        }
+
+        // The first row that is later than the version.
+        size_t upperBound(const Version& version) const {
+            return partitionPoint([this, &version](size_t row) { return compare(row, version.versionParts()) <= 0; });
+        }
+
+        template<typename Predicate>
+        size_t partitionPoint(Predicate isBefore) const {
+            size_t first = 0;
+            size_t count = rowCount;
+            while (count > 0) {
+                size_t half = count / 2;
+                if (isBefore(first + half)) {
+                    first += half + 1;
+                    count -= half + 1;
+                }
+                else
+                    count = half;
+            }
+
+            return first;
+        }
+
+        // Merge rows [row, lastRow) with the delta versions [it, last),
+        // taking rows first when they are equivalent.
+        template<typename Function>
+        void scan(size_t row, size_t lastRow, DeltaIterator it, DeltaIterator last, Function f) const {
+            while (row < lastRow || it != last) {
+                if (it == last || (row < lastRow && compare(row, it->versionParts()) <= 0)) {
+                    RowString ver(rowString(row++));
+                    f(ver.data, ver.length);
+                }
+                else {
+                    f(it->str().data(), it->str().size());
+                    ++it;
+                }
+            }
+        }
+    };
+}
+
+#endif
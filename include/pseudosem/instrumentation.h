@@ -0,0 +1,236 @@
+#ifndef PSEUDOSEM_INSTRUMENTATION
+#define PSEUDOSEM_INSTRUMENTATION
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+// Counters and latency histograms for pseudosem's hot paths. These are only
+// collected if PSEUDOSEM_INSTRUMENT is defined before pseudosem.h is
+// included, which must be done in every translation unit of a program.
+// Otherwise pseudosem's hooks compile to nothing.
+//
+// Each thread updates its own counters without synchronisation, and they
+// are only added up when a snapshot is taken. Comparisons of C strings and
+// string views, and comparisons with a policy, aren't counted, so that they
+// can still be constexpr.
+namespace pseudosem {
+    namespace instrumentation {
+        enum Counter {
+            // Versions parsed, and the tokens found in them.
+            parses,
+            parsedTokens,
+            // Comparisons of strings or parsed versions, by the part of the
+            // versions that decided them.
+            compares,
+            decidedByReleaseNumbers,
+            decidedByReleaseStrings,
+            decidedByPreRelease,
+            equivalentComparisons,
+            // Heap allocations made by pseudosem's own containers.
+            allocations,
+            // Exceptions thrown by pseudosem.
+            exceptions,
+            counterCount
+        };
+
+        enum Operation {
+            parseOperation,
+            compareOperation,
+            operationCount
+        };
+
+        // Latencies are counted in buckets of powers of two nanoseconds:
+        // bucket i counts latencies of at least 2^i ns and less than
+        // 2^(i + 1) ns, except that the first bucket also counts shorter
+        // latencies and the last bucket all longer ones.
+        enum { latencyBuckets = 32 };
+
+        struct Snapshot {
+            uint64_t counters[counterCount];
+            uint64_t latencies[operationCount][latencyBuckets];
+
+            uint64_t count(Counter counter) const {
+                return counters[counter];
+            }
+
+            // The upper bound of the latency bucket that the given fraction
+            // (e.g. 0.99) of the operations fall within, in nanoseconds, or
+            // 0 if there were none.
+            uint64_t latencyPercentile(Operation operation, double fraction) const {
+                uint64_t total = 0;
+                for (uint64_t count : latencies[operation])
+                    total += count;
+
+                if (total == 0)
+                    return 0;
+
+                uint64_t seen = 0;
+                for (size_t i = 0; i < latencyBuckets; ++i) {
+                    seen += latencies[operation][i];
+                    if (seen >= fraction * total)
+                        return uint64_t(1) << (i + 1);
+                }
+
+                return uint64_t(1) << latencyBuckets;
+            }
+        };
+
+        namespace detail {
+            struct ThreadCounters {
+                std::atomic<uint64_t> counters[counterCount];
+                std::atomic<uint64_t> latencies[operationCount][latencyBuckets];
+
+                ThreadCounters() {
+                    for (std::atomic<uint64_t>& counter : counters)
+                        counter.store(0, std::memory_order_relaxed);
+
+                    for (auto& operation : latencies) {
+                        for (std::atomic<uint64_t>& bucket : operation)
+                            bucket.store(0, std::memory_order_relaxed);
+                    }
+                }
+
+                void addTo(Snapshot& snapshot) const {
+                    for (size_t i = 0; i < counterCount; ++i)
+                        snapshot.counters[i] += counters[i].load(std::memory_order_relaxed);
+
+                    for (size_t i = 0; i < operationCount; ++i) {
+                        for (size_t j = 0; j < latencyBuckets; ++j)
+                            snapshot.latencies[i][j] += latencies[i][j].load(std::memory_order_relaxed);
+                    }
+                }
+            };
+
+            // The counters of all running threads, and the totals of
+            // threads that have exited.
+            class Registry {
+            public:
+                void add(ThreadCounters* counters) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    threads.push_back(counters);
+                }
+
+                void remove(ThreadCounters* counters) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    counters->addTo(exited);
+                    threads.erase(std::find(threads.begin(), threads.end(), counters));
+                }
+
+                Snapshot snapshot() {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    Snapshot result(total());
+                    for (size_t i = 0; i < counterCount; ++i)
+                        result.counters[i] -= baseline.counters[i];
+
+                    for (size_t i = 0; i < operationCount; ++i) {
+                        for (size_t j = 0; j < latencyBuckets; ++j)
+                            result.latencies[i][j] -= baseline.latencies[i][j];
+                    }
+
+                    return result;
+                }
+
+                // Only the owning thread may write its counters, so resetting
+                // records the current totals to subtract from later snapshots
+                // instead of clearing them.
+                void reset() {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    baseline = total();
+                }
+
+            private:
+                std::mutex mutex;
+                std::vector<ThreadCounters*> threads;
+                Snapshot exited = Snapshot();
+                Snapshot baseline = Snapshot();
+
+                Snapshot total() const {
+                    Snapshot result(exited);
+                    for (const ThreadCounters* counters : threads)
+                        counters->addTo(result);
+
+                    return result;
+                }
+            };
+
+            inline Registry& registry() {
+                static Registry instance;
+                return instance;
+            }
+
+            // Registers a thread's counters for as long as the thread runs.
+            class ThreadSlot {
+            public:
+                ThreadSlot() {
+                    registry().add(&counters);
+                }
+
+                ~ThreadSlot() {
+                    registry().remove(&counters);
+                }
+
+                ThreadCounters counters;
+            };
+
+            inline ThreadCounters& threadCounters() {
+                static thread_local ThreadSlot slot;
+                return slot.counters;
+            }
+
+            // Only the owning thread writes its counters, so they don't need
+            // an atomic read-modify-write.
+            inline void increment(std::atomic<uint64_t>& counter, uint64_t amount) {
+                counter.store(counter.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+            }
+
+            inline void add(Counter counter, uint64_t amount) {
+                increment(threadCounters().counters[counter], amount);
+            }
+
+            // Records the time between its construction and destruction.
+            class Timer {
+            public:
+                explicit Timer(Operation operation) : operation(operation), start(std::chrono::steady_clock::now()) {}
+
+                ~Timer() {
+                    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+                    uint64_t nanoseconds = static_cast<uint64_t>(elapsed.count());
+
+                    size_t bucket = 0;
+                    while (nanoseconds > 1 && bucket + 1 < latencyBuckets) {
+                        nanoseconds >>= 1;
+                        ++bucket;
+                    }
+
+                    increment(threadCounters().latencies[operation][bucket], 1);
+                }
+
+                Timer(const Timer&) = delete;
+                Timer& operator=(const Timer&) = delete;
+
+            private:
+                Operation operation;
+                std::chrono::steady_clock::time_point start;
+            };
+        }
+
+        // Add up the counters of all threads, including threads that have
+        // exited. Counters being updated while this runs may or may not be
+        // included.
+        inline Snapshot snapshot() {
+            return detail::registry().snapshot();
+        }
+
+        // Set all counters to zero, as seen by later snapshots. This is safe
+        // while other threads are using pseudosem.
+        inline void reset() {
+            detail::registry().reset();
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,253 @@
+#ifndef PSEUDOSEM_INTERNER
+#define PSEUDOSEM_INTERNER
+
+#include "../pseudosem.h"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace pseudosem {
+    // A thread-safe table that maps version strings to dense IDs, parsing
+    // each distinct string only once, and that maintains an integer order
+    // key for each version so that interned versions can be compared
+    // without comparing their parts.
+    //
+    // Strings are looked up in one of several independently-locked shards,
+    // so lookups from many threads rarely contend. Comparing and accessing
+    // interned versions doesn't lock at all.
+    //
+    // Equivalent versions (e.g. "1.0" and "1.0.0") get different IDs but the
+    // same order key. Keys for new versions are picked from the gap between
+    // their neighbours' keys, and when there is no gap left all keys are
+    // spread out again. This is guarded by a sequence lock, and comparisons
+    // that race with it fall back to comparing the versions' parts.
+    class VersionInterner {
+    public:
+        typedef uint32_t Id;
+
+        VersionInterner() : chunks(new std::atomic<Record*>[maxChunks]), count(0), sequence(0), ordered(ClassLess(this)) {
+            for (size_t i = 0; i < maxChunks; ++i)
+                chunks[i].store(nullptr, std::memory_order_relaxed);
+        }
+
+        ~VersionInterner() {
+            for (size_t i = 0; i < maxChunks; ++i)
+                delete[] chunks[i].load(std::memory_order_relaxed);
+        }
+
+        VersionInterner(const VersionInterner&) = delete;
+        VersionInterner& operator=(const VersionInterner&) = delete;
+
+        // Get the ID of the given version string, interning it if it hasn't
+        // been seen before. Throws std::length_error if the interner is full.
+        Id intern(const std::string& ver) {
+            Shard& shard = shardFor(ver);
+            std::lock_guard<std::mutex> shardLock(shard.mutex);
+
+            auto it = shard.ids.find(ver);
+            if (it != shard.ids.end())
+                return it->second;
+
+            Id id = insert(ver);
+            shard.ids.insert(std::make_pair(ver, id));
+            return id;
+        }
+
+        // Look up the ID of the given version string without interning it,
+        // returning false if it hasn't been interned.
+        bool find(const std::string& ver, Id& id) const {
+            Shard& shard = shardFor(ver);
+            std::lock_guard<std::mutex> shardLock(shard.mutex);
+
+            auto it = shard.ids.find(ver);
+            if (it == shard.ids.end())
+                return false;
+
+            id = it->second;
+            return true;
+        }
+
+        // Compare two interned versions, returning less than, equal to or
+        // greater than zero in the same way as pseudosem::compare().
+        int compare(Id id1, Id id2) const {
+            const Record& record1 = record(id1);
+            const Record& record2 = record(id2);
+
+            uint64_t before = sequence.load(std::memory_order_acquire);
+            if (before % 2 == 0) {
+                uint64_t key1 = record1.equivalence->key.load(std::memory_order_relaxed);
+                uint64_t key2 = record2.equivalence->key.load(std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_acquire);
+
+                if (sequence.load(std::memory_order_relaxed) == before)
+                    return key1 == key2 ? 0 : (key1 < key2 ? -1 : 1);
+            }
+
+            // The keys are being reassigned, so compare the versions instead.
+            return record1.version.compare(record2.version);
+        }
+
+        // The interned version with the given ID.
+        const Version& version(Id id) const {
+            return record(id).version;
+        }
+
+        // An integer that orders the version with the given ID in the same
+        // way as the other versions interned. Keys may change when versions
+        // are interned, so only compare keys obtained while no versions are
+        // being interned.
+        uint64_t orderKey(Id id) const {
+            return record(id).equivalence->key.load(std::memory_order_acquire);
+        }
+
+        // The number of version strings interned.
+        size_t size() const {
+            return count.load(std::memory_order_acquire);
+        }
+
+    private:
+        static const size_t chunkSize = 4096;
+        static const size_t maxChunks = 65536;
+        static const size_t shardCount = 64;
+
+        // The first key assigned, and the gap left between keys assigned at
+        // either end of the order.
+        static const uint64_t firstKey = uint64_t(1) << 63;
+        static const uint64_t keyStep = uint64_t(1) << 32;
+
+        // A set of equivalent versions, which share an order key.
+        struct Equivalence {
+            explicit Equivalence(Id representative) : key(0), representative(representative) {}
+
+            std::atomic<uint64_t> key;
+            Id representative;
+        };
+
+        struct Record {
+            Version version;
+            Equivalence* equivalence;
+        };
+
+        struct Shard {
+            std::mutex mutex;
+            std::unordered_map<std::string, Id> ids;
+        };
+
+        class ClassLess {
+        public:
+            explicit ClassLess(const VersionInterner* interner) : interner(interner) {}
+
+            bool operator()(const Equivalence* a, const Equivalence* b) const {
+                return interner->version(a->representative) < interner->version(b->representative);
+            }
+
+        private:
+            const VersionInterner* interner;
+        };
+
+        std::unique_ptr<std::atomic<Record*>[]> chunks;
+        std::atomic<size_t> count;
+        mutable Shard shards[shardCount];
+
+        // Writers hold this while adding records and assigning keys.
+        std::mutex writeMutex;
+        std::atomic<uint64_t> sequence;
+        std::deque<Equivalence> equivalences;
+        std::set<Equivalence*, ClassLess> ordered;
+
+        Shard& shardFor(const std::string& ver) const {
+            return shards[std::hash<std::string>()(ver) % shardCount];
+        }
+
+        const Record& record(Id id) const {
+            return chunks[id / chunkSize].load(std::memory_order_acquire)[id % chunkSize];
+        }
+
+        Id insert(const std::string& ver) {
+            std::lock_guard<std::mutex> writeLock(writeMutex);
+
+            size_t index = count.load(std::memory_order_relaxed);
+            if (index == chunkSize * maxChunks) {
+                PSEUDOSEM_COUNT(exceptions, 1);
+                throw std::length_error("pseudosem: too many versions interned");
+            }
+
+            Record* chunk = chunks[index / chunkSize].load(std::memory_order_relaxed);
+            if (chunk == nullptr) {
+                chunk = new Record[chunkSize];
+                chunks[index / chunkSize].store(chunk, std::memory_order_release);
+            }
+
+            Id id = static_cast<Id>(index);
+            Record& record = chunk[index % chunkSize];
+            record.version.assign(ver);
+
+            equivalences.emplace_back(id);
+            Equivalence* equivalence = &equivalences.back();
+
+            auto inserted = ordered.insert(equivalence);
+            if (inserted.second)
+                equivalence->key.store(keyBetweenNeighbours(inserted.first), std::memory_order_relaxed);
+            else {
+                // An equivalent version has already been interned.
+                equivalences.pop_back();
+                equivalence = *inserted.first;
+            }
+
+            record.equivalence = equivalence;
+            count.store(index + 1, std::memory_order_release);
+
+            return id;
+        }
+
+        uint64_t keyBetweenNeighbours(std::set<Equivalence*, ClassLess>::iterator it) {
+            bool hasPrevious = it != ordered.begin();
+            bool hasNext = std::next(it) != ordered.end();
+
+            uint64_t previous = hasPrevious ? (*std::prev(it))->key.load(std::memory_order_relaxed) : 0;
+            uint64_t next = hasNext ? (*std::next(it))->key.load(std::memory_order_relaxed) : UINT64_MAX;
+
+            if (!hasPrevious && !hasNext)
+                return firstKey;
+
+            // Leave room for more versions after the latest or before the
+            // earliest, since new versions are usually added there.
+            if (!hasNext && UINT64_MAX - previous > keyStep)
+                return previous + keyStep;
+            if (!hasPrevious && next > keyStep)
+                return next - keyStep;
+
+            if (next - previous >= 2)
+                return previous + (next - previous) / 2;
+
+            respaceKeys();
+            return (*it)->key.load(std::memory_order_relaxed);
+        }
+
+        // Spread out the keys of all versions evenly.
+        void respaceKeys() {
+            uint64_t step = UINT64_MAX / (ordered.size() + 1);
+            uint64_t key = step;
+
+            sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+
+            for (Equivalence* equivalence : ordered) {
+                equivalence->key.store(key, std::memory_order_relaxed);
+                key += step;
+            }
+
+            sequence.store(sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        }
+    };
+}
+
+#endif
@@ -0,0 +1,216 @@
+#ifndef PSEUDOSEM_SORT
+#define PSEUDOSEM_SORT
+
+#include "../pseudosem.h"
+
+#include <exception>
+#include <iterator>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace pseudosem {
+    namespace detail {
+        inline Token toToken(const std::string& ver) {
+            return Token{ ver.data(), ver.size() };
+        }
+
+        inline Token toToken(const char* ver) {
+            return Token{ ver, std::strlen(ver) };
+        }
+
+#ifdef PSEUDOSEM_HAS_STRING_VIEW
+        inline Token toToken(std::string_view ver) {
+            return Token{ ver.data(), ver.size() };
+        }
+#endif
+
+        struct Identity {
+            template<typename T>
+            T&& operator()(T&& value) const {
+                return std::forward<T>(value);
+            }
+        };
+
+        // Get the number of threads to use for the given amount of work,
+        // so that each thread gets at least minPerThread items.
+        inline size_t threadCount(size_t requested, size_t items, size_t minPerThread) {
+            if (requested == 0)
+                requested = std::max(1u, std::thread::hardware_concurrency());
+
+            return std::max<size_t>(1, std::min(requested, items / minPerThread));
+        }
+
+        // Call function(i) for each i in [0, count), each on its own thread,
+        // then rethrow the first exception thrown, if any.
+        template<typename Function>
+        void parallelFor(size_t count, Function function) {
+            std::vector<std::exception_ptr> errors(count);
+            auto run = [&function, &errors](size_t i) {
+                try {
+                    function(i);
+                }
+                catch (...) {
+                    errors[i] = std::current_exception();
+                }
+            };
+
+            std::vector<std::thread> threads;
+            threads.reserve(count);
+            try {
+                for (size_t i = 1; i < count; ++i)
+                    threads.push_back(std::thread(run, i));
+            }
+            catch (...) {
+                for (std::thread& thread : threads)
+                    thread.join();
+                throw;
+            }
+
+            if (count > 0)
+                run(0);
+
+            for (std::thread& thread : threads)
+                thread.join();
+
+            for (std::exception_ptr& error : errors) {
+                if (error)
+                    std::rethrow_exception(error);
+            }
+        }
+
+        // Return the indices [0, count) in sorted order, where compare(a, b)
+        // compares the items at indices a and b like VersionParts::compare().
+        // Equivalent items keep their original relative order, so the result
+        // doesn't depend on the number of threads used.
+        template<typename Compare>
+        std::vector<size_t> sortedOrder(size_t count, Compare compare, size_t threads) {
+            std::vector<size_t> order(count);
+            for (size_t i = 0; i < order.size(); ++i)
+                order[i] = i;
+
+            auto less = [&compare](size_t a, size_t b) {
+                int result = compare(a, b);
+                return result < 0 || (result == 0 && a < b);
+            };
+
+            // Sort a chunk per thread, then merge pairs of adjacent chunks
+            // in parallel until only one is left.
+            std::vector<size_t> bounds;
+            for (size_t i = 0; i < threads; ++i)
+                bounds.push_back(i * order.size() / threads);
+            bounds.push_back(order.size());
+
+            parallelFor(threads, [&order, &bounds, &less](size_t i) {
+                std::sort(order.begin() + bounds[i], order.begin() + bounds[i + 1], less);
+            });
+
+            std::vector<size_t> buffer(order.size());
+            while (bounds.size() > 2) {
+                size_t merges = (bounds.size() - 1) / 2;
+                bool hasOddChunk = (bounds.size() - 1) % 2 != 0;
+
+                parallelFor(merges + (hasOddChunk ? 1 : 0), [&](size_t i) {
+                    auto first = order.begin() + bounds[2 * i];
+                    auto middle = order.begin() + bounds[2 * i + 1];
+                    auto output = buffer.begin() + bounds[2 * i];
+
+                    if (i == merges)
+                        std::copy(first, middle, output);
+                    else
+                        std::merge(first, middle, middle, order.begin() + bounds[2 * i + 2], output, less);
+                });
+
+                std::vector<size_t> newBounds;
+                for (size_t i = 0; i < bounds.size(); i += 2)
+                    newBounds.push_back(bounds[i]);
+                if (hasOddChunk)
+                    newBounds.push_back(bounds.back());
+
+                bounds.swap(newBounds);
+                order.swap(buffer);
+            }
+
+            return order;
+        }
+
+        // Return the indices of the given parsed versions in sorted order.
+        inline std::vector<size_t> sortedOrder(const std::vector<VersionParts>& parts, size_t threads) {
+            return sortedOrder(parts.size(), [&parts](size_t a, size_t b) { return parts[a].compare(parts[b]); }, threads);
+        }
+    }
+
+    // Sort a range of elements by version, parsing each element's version
+    // only once and sorting on multiple threads. The projection is called on
+    // each element to get its version, and must return a reference to a
+    // std::string stored in the element, or a const char* or
+    // std::string_view that points into it. Equivalent versions keep their
+    // original relative order, so the result is the same as a serial stable
+    // sort using compare(). If threadCount is 0, one thread per hardware
+    // thread is used.
+    template<typename RandomIt, typename Projection>
+    void stable_sort(RandomIt first, RandomIt last, Projection projection, unsigned threadCount) {
+        typedef typename std::iterator_traits<RandomIt>::value_type Value;
+        typedef decltype(projection(*first)) Projected;
+        static_assert(std::is_lvalue_reference<Projected>::value
+                      || !std::is_same<typename std::decay<Projected>::type, std::string>::value,
+                      "The projection must return a reference to a string in the element, not a copy.");
+
+        size_t count = std::distance(first, last);
+        if (count < 2)
+            return;
+
+        // Parsing is cheap compared to sorting, so splitting it needs less
+        // work per thread to be worthwhile.
+        std::vector<detail::VersionParts> parts(count);
+        size_t threads = detail::threadCount(threadCount, count, 1024);
+        detail::parallelFor(threads, [&](size_t i) {
+            for (size_t j = i * count / threads; j < (i + 1) * count / threads; ++j) {
+                detail::Token token = detail::toToken(projection(first[j]));
+                parts[j] = detail::VersionParts(token.data, token.size);
+            }
+        });
+
+        std::vector<size_t> order(detail::sortedOrder(parts, detail::threadCount(threadCount, count, 4096)));
+
+        // The parts point into the elements, so are invalid once any are
+        // moved.
+        parts.clear();
+
+        std::vector<Value> sorted;
+        sorted.reserve(count);
+        for (size_t index : order)
+            sorted.push_back(std::move(first[index]));
+
+        std::move(sorted.begin(), sorted.end(), first);
+    }
+
+    template<typename RandomIt, typename Projection>
+    void stable_sort(RandomIt first, RandomIt last, Projection projection) {
+        pseudosem::stable_sort(first, last, projection, 0);
+    }
+
+    template<typename RandomIt>
+    void stable_sort(RandomIt first, RandomIt last) {
+        pseudosem::stable_sort(first, last, detail::Identity(), 0);
+    }
+
+    // The same as stable_sort(), which is already as fast as an unstable
+    // sort would be.
+    template<typename RandomIt, typename Projection>
+    void sort(RandomIt first, RandomIt last, Projection projection, unsigned threadCount) {
+        pseudosem::stable_sort(first, last, projection, threadCount);
+    }
+
+    template<typename RandomIt, typename Projection>
+    void sort(RandomIt first, RandomIt last, Projection projection) {
+        pseudosem::stable_sort(first, last, projection, 0);
+    }
+
+    template<typename RandomIt>
+    void sort(RandomIt first, RandomIt last) {
+        pseudosem::stable_sort(first, last, detail::Identity(), 0);
+    }
+}
+
+#endif
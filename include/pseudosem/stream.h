@@ -0,0 +1,195 @@
+#ifndef PSEUDOSEM_STREAM
+#define PSEUDOSEM_STREAM
+
+#include "../pseudosem.h"
+
+#include <functional>
+#include <istream>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pseudosem {
+    namespace detail {
+        // Keeps whichever version it is given that sorts furthest in one
+        // direction.
+        class BestVersion {
+        public:
+            explicit BestVersion(int direction) : direction(direction), hasVersion(false) {}
+
+            void add(const char* ver, size_t length) {
+                if (!hasVersion) {
+                    best.assign(ver, length);
+                    hasVersion = true;
+                    return;
+                }
+
+                parts.assign(ver, length);
+                if (direction * parts.compare(best.versionParts()) > 0)
+                    best.assign(ver, length);
+            }
+
+            void add(const std::string& ver) {
+                add(ver.data(), ver.size());
+            }
+
+            bool empty() const {
+                return !hasVersion;
+            }
+
+            // The first of the best versions added. Throws std::logic_error
+            // if no versions have been added.
+            const Version& version() const {
+                if (!hasVersion) {
+                    PSEUDOSEM_COUNT(exceptions, 1);
+                    throw std::logic_error("pseudosem: no versions have been added");
+                }
+
+                return best;
+            }
+
+        private:
+            int direction;
+            bool hasVersion;
+            Version best;
+            VersionParts parts;
+        };
+
+        // Orders lists of release numbers written as digits by their values,
+        // which may be too large for an integer type.
+        struct ReleaseNumbersLess {
+            bool operator()(const std::vector<std::string>& numbers1, const std::vector<std::string>& numbers2) const {
+                return std::lexicographical_compare(numbers1.begin(), numbers1.end(), numbers2.begin(), numbers2.end(),
+                    [](const std::string& number1, const std::string& number2) {
+                        return compareNumbers(Token{ number1.data(), number1.size() }, Token{ number2.data(), number2.size() }) < 0;
+                    });
+            }
+        };
+    }
+
+    // Keeps the latest version it is given, using memory independent of the
+    // number of versions.
+    class LatestVersion : public detail::BestVersion {
+    public:
+        LatestVersion() : BestVersion(1) {}
+    };
+
+    // Keeps the earliest version it is given, using memory independent of
+    // the number of versions.
+    class EarliestVersion : public detail::BestVersion {
+    public:
+        EarliestVersion() : BestVersion(-1) {}
+    };
+
+    // Keeps the latest count versions it is given, in a min-heap of parsed
+    // versions, so that each new version only needs to be compared against
+    // the earliest of those kept.
+    class LatestVersions {
+    public:
+        explicit LatestVersions(size_t count) : count(count) {
+            heap.reserve(count);
+        }
+
+        void add(const char* ver, size_t length) {
+            if (count == 0)
+                return;
+
+            if (heap.size() < count) {
+                heap.push_back(Version());
+                heap.back().assign(ver, length);
+                std::push_heap(heap.begin(), heap.end(), std::greater<Version>());
+                return;
+            }
+
+            parts.assign(ver, length);
+            if (parts.compare(heap.front().versionParts()) <= 0)
+                return;
+
+            // Reuse the evicted version's memory for the new version.
+            std::pop_heap(heap.begin(), heap.end(), std::greater<Version>());
+            heap.back().assign(ver, length);
+            std::push_heap(heap.begin(), heap.end(), std::greater<Version>());
+        }
+
+        void add(const std::string& ver) {
+            add(ver.data(), ver.size());
+        }
+
+        // The versions kept, latest first.
+        std::vector<Version> versions() const {
+            std::vector<Version> versions(heap);
+            std::sort(versions.begin(), versions.end(), std::greater<Version>());
+            return versions;
+        }
+
+    private:
+        size_t count;
+        std::vector<Version> heap;
+        detail::VersionParts parts;
+    };
+
+    // Counts versions by their first depth release numbers, e.g. by major
+    // version for a depth of 1, or by major and minor versions for a depth
+    // of 2. Missing release numbers count as zero, so "1" is counted under
+    // 1.0 for a depth of 2. Release numbers are kept as digits without
+    // leading zeroes, so numbers of any length are counted exactly.
+    class ReleaseCounts {
+    public:
+        typedef std::map<std::vector<std::string>, size_t, detail::ReleaseNumbersLess> Counts;
+
+        explicit ReleaseCounts(size_t depth) : key(depth) {}
+
+        void add(const char* ver, size_t length) {
+            parts.assign(ver, length);
+            for (size_t i = 0; i < key.size(); ++i) {
+                detail::Token digits = parts.releaseNumber(i).digits;
+                if (digits.size == 0)
+                    key[i].assign(1, '0');
+                else
+                    key[i].assign(digits.data, digits.size);
+            }
+
+            // Look up the key before inserting it to avoid copying it.
+            Counts::iterator it = releaseCounts.find(key);
+            if (it == releaseCounts.end())
+                releaseCounts.insert(Counts::value_type(key, 1));
+            else
+                ++it->second;
+        }
+
+        void add(const std::string& ver) {
+            add(ver.data(), ver.size());
+        }
+
+        // The number of versions for each list of release numbers, ordered
+        // by those release numbers.
+        const Counts& counts() const {
+            return releaseCounts;
+        }
+
+    private:
+        std::vector<std::string> key;
+        Counts releaseCounts;
+        detail::VersionParts parts;
+    };
+
+    // Read newline-delimited versions from the stream and add each non-empty
+    // line to the reducer, which can be any of the classes above. A line
+    // buffer is reused, so only the reducer's memory usage grows.
+    template<typename Reducer>
+    Reducer& reduce(std::istream& in, Reducer& reducer) {
+        std::string line;
+        while (std::getline(in, line)) {
+            if (!line.empty() && line[line.size() - 1] == '\r')
+                line.erase(line.size() - 1);
+
+            if (!line.empty())
+                reducer.add(line);
+        }
+
+        return reducer;
+    }
+}
+
+#endif
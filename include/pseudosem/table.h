@@ -0,0 +1,485 @@
+#ifndef PSEUDOSEM_TABLE
+#define PSEUDOSEM_TABLE
+
+#include "sort.h"
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace pseudosem {
+    namespace detail {
+        // Copies strings into large blocks that are only freed together, so
+        // that copies never move and can be pointed into.
+        class MonotonicArena {
+        public:
+            explicit MonotonicArena(size_t blockSize = 64 * 1024) : blockSize(blockSize), next(nullptr), remaining(0) {}
+
+            const char* copy(const char* data, size_t size) {
+                if (size > remaining) {
+                    size_t newBlockSize = std::max(blockSize, size);
+                    blocks.push_back(std::unique_ptr<char[]>(new char[newBlockSize]));
+                    next = blocks.back().get();
+                    remaining = newBlockSize;
+                }
+
+                char* result = next;
+                if (size > 0)
+                    std::memcpy(result, data, size);
+
+                next += size;
+                remaining -= size;
+                return result;
+            }
+
+        private:
+            size_t blockSize;
+            std::vector<std::unique_ptr<char[]>> blocks;
+            char* next;
+            size_t remaining;
+        };
+
+        // The first release numbers of each row of a table, saturated to 32
+        // bits, are also stored in a column each, so that a version can be
+        // compared with several rows at once. Saturating keeps their order,
+        // and the numbers after a saturated number are stored as zeroes, so
+        // two rows with the same saturated number are compared in full.
+        enum { leadNumberCount = 3 };
+
+        inline void getLeadNumbers(const Number* numbers, size_t count, uint32_t* leadNumbers) {
+            bool saturated = false;
+            for (size_t i = 0; i < leadNumberCount; ++i) {
+                uint64_t value = i < count && !saturated ? numbers[i].value : 0;
+                leadNumbers[i] = value < 0xffffffff ? static_cast<uint32_t>(value) : 0xffffffff;
+                saturated = saturated || value >= 0xffffffff;
+            }
+        }
+
+        // Compare the version's lead numbers with those of rows [first,
+        // count), setting each row's result to -1 or 1, or to 0 if they are
+        // the same.
+        inline void compareLeadNumbersScalar(const uint32_t* const* columns, const uint32_t* version, size_t first, size_t count, int* out) {
+            for (size_t row = first; row < count; ++row) {
+                int result = 0;
+                for (size_t i = 0; i < leadNumberCount; ++i) {
+                    if (version[i] != columns[i][row]) {
+                        result = version[i] < columns[i][row] ? -1 : 1;
+                        break;
+                    }
+                }
+
+                out[row] = result;
+            }
+        }
+
+#ifdef PSEUDOSEM_HAS_SSE2
+        inline void compareLeadNumbersSse2(const uint32_t* const* columns, const uint32_t* version, size_t first, size_t count, int* out) {
+            // Unsigned numbers are compared as signed numbers by flipping
+            // their sign bits.
+            const __m128i sign = _mm_set1_epi32(std::numeric_limits<int32_t>::min());
+            __m128i versionNumbers[leadNumberCount];
+            for (size_t i = 0; i < leadNumberCount; ++i)
+                versionNumbers[i] = _mm_xor_si128(_mm_set1_epi32(static_cast<int32_t>(version[i])), sign);
+
+            size_t row = first;
+            for (; row + 4 <= count; row += 4) {
+                __m128i earlier = _mm_setzero_si128();
+                __m128i later = _mm_setzero_si128();
+                __m128i same = _mm_set1_epi32(-1);
+                for (size_t i = 0; i < leadNumberCount; ++i) {
+                    __m128i numbers = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(columns[i] + row)), sign);
+                    earlier = _mm_or_si128(earlier, _mm_and_si128(same, _mm_cmplt_epi32(versionNumbers[i], numbers)));
+                    later = _mm_or_si128(later, _mm_and_si128(same, _mm_cmpgt_epi32(versionNumbers[i], numbers)));
+                    same = _mm_and_si128(same, _mm_cmpeq_epi32(versionNumbers[i], numbers));
+                }
+
+                // The masks are -1 where set, so this gives -1, 0 or 1.
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(out + row), _mm_sub_epi32(earlier, later));
+            }
+
+            compareLeadNumbersScalar(columns, version, row, count, out);
+        }
+#endif
+
+#ifdef PSEUDOSEM_HAS_AVX2
+        PSEUDOSEM_TARGET_AVX2 inline void compareLeadNumbersAvx2(const uint32_t* const* columns, const uint32_t* version, size_t first, size_t count, int* out) {
+            const __m256i sign = _mm256_set1_epi32(std::numeric_limits<int32_t>::min());
+            __m256i versionNumbers[leadNumberCount];
+            for (size_t i = 0; i < leadNumberCount; ++i)
+                versionNumbers[i] = _mm256_xor_si256(_mm256_set1_epi32(static_cast<int32_t>(version[i])), sign);
+
+            size_t row = first;
+            for (; row + 8 <= count; row += 8) {
+                __m256i earlier = _mm256_setzero_si256();
+                __m256i later = _mm256_setzero_si256();
+                __m256i same = _mm256_set1_epi32(-1);
+                for (size_t i = 0; i < leadNumberCount; ++i) {
+                    __m256i numbers = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(columns[i] + row)), sign);
+                    earlier = _mm256_or_si256(earlier, _mm256_and_si256(same, _mm256_cmpgt_epi32(numbers, versionNumbers[i])));
+                    later = _mm256_or_si256(later, _mm256_and_si256(same, _mm256_cmpgt_epi32(versionNumbers[i], numbers)));
+                    same = _mm256_and_si256(same, _mm256_cmpeq_epi32(versionNumbers[i], numbers));
+                }
+
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + row), _mm256_sub_epi32(earlier, later));
+            }
+
+            compareLeadNumbersScalar(columns, version, row, count, out);
+        }
+#endif
+
+        typedef void (*LeadNumberComparer)(const uint32_t* const*, const uint32_t*, size_t, size_t, int*);
+
+        inline LeadNumberComparer chooseLeadNumberComparer() {
+#ifdef PSEUDOSEM_HAS_AVX2
+            if (hasAvx2())
+                return compareLeadNumbersAvx2;
+#endif
+#ifdef PSEUDOSEM_HAS_SSE2
+            return compareLeadNumbersSse2;
+#else
+            return compareLeadNumbersScalar;
+#endif
+        }
+
+        // Compare lead numbers with the fastest comparer that the CPU
+        // supports.
+        inline void compareLeadNumbers(const uint32_t* const* columns, const uint32_t* version, size_t count, int* out) {
+            static const LeadNumberComparer comparer = chooseLeadNumberComparer();
+            comparer(columns, version, 0, count, out);
+        }
+    }
+
+    // A batch of versions parsed into columns instead of one object each:
+    // the release numbers of all versions are stored in one array, as are
+    // their release and pre-release strings, and each row only holds the
+    // offsets of its parts in those arrays and some flags. The version
+    // strings are copied into an arena that the parts point into.
+    //
+    // Comparing, sorting and searching rows only reads these arrays, so
+    // scanning many versions touches far less memory than scanning Version
+    // objects. Rows can be appended, but not changed or removed.
+    class VersionTable {
+    public:
+        VersionTable() {}
+
+        explicit VersionTable(const std::vector<std::string>& versions) {
+            append(versions.begin(), versions.end());
+        }
+
+        // Parse a range of std::strings, const char*s or std::string_views.
+        template<typename Iterator>
+        VersionTable(Iterator first, Iterator last) {
+            append(first, last);
+        }
+
+        template<typename Iterator>
+        void append(Iterator first, Iterator last) {
+            detail::VersionParts parts;
+            for (; first != last; ++first) {
+                detail::Token ver(detail::toToken(*first));
+                append(ver.data, ver.size, parts);
+            }
+        }
+
+        void append(const char* ver, size_t length) {
+            detail::VersionParts parts;
+            append(ver, length, parts);
+        }
+
+        void append(const std::string& ver) {
+            append(ver.data(), ver.size());
+        }
+
+        size_t size() const {
+            return rows.size();
+        }
+
+        bool empty() const {
+            return rows.empty();
+        }
+
+        std::string str(size_t row) const {
+            return std::string(rows[row].text, rows[row].length);
+        }
+
+        Version version(size_t row) const {
+            return Version(str(row));
+        }
+
+        bool isPreRelease(size_t row) const {
+            return (rows[row].flags & preReleaseFlag) != 0;
+        }
+
+        int compare(size_t row1, size_t row2) const {
+            return compare(view(row1), view(row2));
+        }
+
+        int compare(size_t row, const Version& version) const {
+            return compare(view(row), view(version.versionParts()));
+        }
+
+        // Return the row indices in sorted order, keeping equivalent
+        // versions in their original order, sorting on up to threads
+        // threads, or one per hardware thread if threads is 0.
+        std::vector<size_t> sortedOrder(size_t threads = 1) const {
+            return detail::sortedOrder(size(), [this](size_t a, size_t b) { return compare(a, b); },
+                                       detail::threadCount(threads, size(), 4096));
+        }
+
+        // Return the first of the latest rows, or size() if there are none.
+        size_t latest() const {
+            if (rows.empty())
+                return size();
+
+            size_t latestRow = 0;
+            View latestView(view(0));
+            for (size_t row = 1; row < rows.size(); ++row) {
+                View rowView(view(row));
+                if (compare(rowView, latestView) > 0) {
+                    latestRow = row;
+                    latestView = rowView;
+                }
+            }
+
+            return latestRow;
+        }
+
+        // Compare the version with every row, as pseudosem::compareMany()
+        // does.
+        void compareMany(const Version& version, int* out) const {
+            View versionView(view(version.versionParts()));
+            uint32_t versionNumbers[detail::leadNumberCount];
+            detail::getLeadNumbers(versionView.numbers, versionView.numberCount, versionNumbers);
+
+            const uint32_t* columns[detail::leadNumberCount];
+            for (size_t i = 0; i < detail::leadNumberCount; ++i)
+                columns[i] = leadNumbers[i].data();
+
+            detail::compareLeadNumbers(columns, versionNumbers, rows.size(), out);
+
+            // Only rows with the same lead numbers need comparing in full.
+            for (size_t row = 0; row < rows.size(); ++row) {
+                if (out[row] == 0)
+                    out[row] = compare(versionView, view(row));
+            }
+        }
+
+        // Return the first row equivalent to the version, or size() if there
+        // is none.
+        size_t find(const Version& version) const {
+            View versionView(view(version.versionParts()));
+            for (size_t row = 0; row < rows.size(); ++row) {
+                if (compare(view(row), versionView) == 0)
+                    return row;
+            }
+
+            return size();
+        }
+
+        // Return the position in order, as returned by sortedOrder(), of the
+        // first row that isn't earlier than the version.
+        size_t lowerBound(const std::vector<size_t>& order, const Version& version) const {
+            View versionView(view(version.versionParts()));
+            return std::partition_point(order.begin(), order.end(), [this, &versionView](size_t row) {
+                return compare(view(row), versionView) < 0;
+            }) - order.begin();
+        }
+
+        // Return the position in order of the first row that is later than
+        // the version.
+        size_t upperBound(const std::vector<size_t>& order, const Version& version) const {
+            View versionView(view(version.versionParts()));
+            return std::partition_point(order.begin(), order.end(), [this, &versionView](size_t row) {
+                return compare(view(row), versionView) <= 0;
+            }) - order.begin();
+        }
+
+    private:
+        enum Flags : uint8_t {
+            stringsFlag = 1,
+            preReleaseFlag = 2
+        };
+
+        // Offsets into the columns are 32 bits, to keep rows small.
+        static const size_t maxColumnSize = std::numeric_limits<uint32_t>::max();
+
+        // Release numbers don't include trailing zeroes, and pre-release
+        // strings follow release strings in the strings column.
+        struct Row {
+            const char* text;
+            uint32_t length;
+            uint32_t firstNumber;
+            uint32_t numberCount;
+            uint32_t firstString;
+            uint32_t releaseStringCount;
+            uint32_t preReleaseStringCount;
+            uint8_t flags;
+        };
+
+        // The parts of a row, or of a version being compared with rows.
+        struct View {
+            const detail::Number* numbers;
+            const detail::Token* releaseStrings;
+            const detail::Token* preReleaseStrings;
+            size_t numberCount;
+            size_t releaseStringCount;
+            size_t preReleaseStringCount;
+            uint8_t flags;
+        };
+
+        // A list of strings for detail::compareTokens().
+        struct TokenSpan {
+            const detail::Token* tokens;
+            size_t count;
+
+            size_t size() const { return count; }
+            const detail::Token& operator[](size_t i) const { return tokens[i]; }
+        };
+
+        detail::MonotonicArena arena;
+        std::vector<Row> rows;
+        std::vector<detail::Number> numbers;
+        std::vector<detail::Token> strings;
+        std::vector<uint32_t> leadNumbers[detail::leadNumberCount];
+
+        void append(const char* ver, size_t length, detail::VersionParts& parts) {
+            parts.assign(ver, length);
+            const detail::VersionParts::Tokens& releaseStrings = parts.releaseTokens();
+            const detail::VersionParts::Tokens& preReleaseStrings = parts.preReleaseTokens();
+            size_t numberCount = parts.significantReleaseNumbers();
+
+            if (length > maxColumnSize ||
+                numbers.size() + numberCount > maxColumnSize ||
+                strings.size() + releaseStrings.size() + preReleaseStrings.size() > maxColumnSize) {
+                PSEUDOSEM_COUNT(exceptions, 1);
+                throw std::length_error("pseudosem: version table is too large");
+            }
+
+            const char* text = arena.copy(ver, length);
+
+            Row row;
+            row.text = text;
+            row.length = static_cast<uint32_t>(length);
+            row.firstNumber = static_cast<uint32_t>(numbers.size());
+            row.numberCount = static_cast<uint32_t>(numberCount);
+            row.firstString = static_cast<uint32_t>(strings.size());
+            row.releaseStringCount = static_cast<uint32_t>(releaseStrings.size());
+            row.preReleaseStringCount = static_cast<uint32_t>(preReleaseStrings.size());
+            row.flags = 0;
+            if (!releaseStrings.empty() || !preReleaseStrings.empty())
+                row.flags |= stringsFlag;
+            if (!preReleaseStrings.empty())
+                row.flags |= preReleaseFlag;
+
+            // Point the parts at the arena's copy of the string.
+            for (size_t i = 0; i < numberCount; ++i) {
+                detail::Number number = parts.numbers()[i];
+                number.digits = rebase(number.digits, ver, text);
+                numbers.push_back(number);
+            }
+
+            uint32_t rowNumbers[detail::leadNumberCount];
+            detail::getLeadNumbers(parts.numbers().begin(), numberCount, rowNumbers);
+            for (size_t i = 0; i < detail::leadNumberCount; ++i)
+                leadNumbers[i].push_back(rowNumbers[i]);
+
+            for (const detail::Token& token : releaseStrings)
+                strings.push_back(rebase(token, ver, text));
+            for (const detail::Token& token : preReleaseStrings)
+                strings.push_back(rebase(token, ver, text));
+
+            rows.push_back(row);
+        }
+
+        static detail::Token rebase(const detail::Token& token, const char* from, const char* to) {
+            return detail::Token{ token.data == nullptr ? nullptr : to + (token.data - from), token.size };
+        }
+
+        View view(size_t index) const {
+            const Row& row = rows[index];
+            const detail::Token* rowStrings = strings.data() + row.firstString;
+            View result = {
+                numbers.data() + row.firstNumber,
+                rowStrings,
+                rowStrings + row.releaseStringCount,
+                row.numberCount,
+                row.releaseStringCount,
+                row.preReleaseStringCount,
+                row.flags
+            };
+
+            return result;
+        }
+
+        static View view(const detail::VersionParts& parts) {
+            const detail::VersionParts::Tokens& releaseStrings = parts.releaseTokens();
+            const detail::VersionParts::Tokens& preReleaseStrings = parts.preReleaseTokens();
+
+            uint8_t flags = 0;
+            if (!releaseStrings.empty() || !preReleaseStrings.empty())
+                flags |= stringsFlag;
+            if (!preReleaseStrings.empty())
+                flags |= preReleaseFlag;
+
+            View result = {
+                parts.numbers().begin(),
+                releaseStrings.begin(),
+                preReleaseStrings.begin(),
+                parts.significantReleaseNumbers(),
+                releaseStrings.size(),
+                preReleaseStrings.size(),
+                flags
+            };
+
+            return result;
+        }
+
+        // Compare in the same way as VersionParts::compare().
+        static int compare(const View& view1, const View& view2) {
+            size_t count = std::min(view1.numberCount, view2.numberCount);
+            for (size_t i = 0; i < count; ++i) {
+                const detail::Number& number1 = view1.numbers[i];
+                const detail::Number& number2 = view2.numbers[i];
+
+                // Only numbers too long to have a value need a closer look.
+                if (number1.value != number2.value || number1.value == detail::longNumber) {
+                    int result = detail::compareNumbers(number1, number2);
+                    if (result != 0)
+                        return result;
+                }
+            }
+
+            // Neither list of release numbers has trailing zeroes, so the
+            // longer one is later.
+            if (view1.numberCount != view2.numberCount)
+                return view1.numberCount > view2.numberCount ? 1 : -1;
+
+            // Most versions have no strings to compare.
+            if (((view1.flags | view2.flags) & stringsFlag) == 0)
+                return 0;
+
+            int result = detail::compareTokens(TokenSpan{ view1.releaseStrings, view1.releaseStringCount },
+                                               TokenSpan{ view2.releaseStrings, view2.releaseStringCount }, true);
+            if (result != 0)
+                return result;
+
+            return detail::compareTokens(TokenSpan{ view1.preReleaseStrings, view1.preReleaseStringCount },
+                                         TokenSpan{ view2.preReleaseStrings, view2.preReleaseStringCount }, false);
+        }
+    };
+
+    // Compare a version with every row of a table, setting out[i] to a
+    // value less than, equal to or greater than zero as the version is
+    // earlier than, equivalent to or later than row i, for which out must
+    // have room. The rows' first release numbers are compared several at a
+    // time with SSE2 or AVX2, and only rows that they don't decide are
+    // compared in full, so this is much faster than comparing each row.
+    inline void compareMany(const Version& query, const VersionTable& versions, int* out) {
+        versions.compareMany(query, out);
+    }
+}
+
+#endif
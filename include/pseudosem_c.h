@@ -0,0 +1,101 @@
+#ifndef PSEUDOSEM_C
+#define PSEUDOSEM_C
+
+/* A C interface to pseudosem, built as the pseudosem_c shared library, for
+   use through FFI from other languages. Batch functions take arrays of
+   strings so that the cost of each call is spread over many versions.
+
+   No function throws or aborts. Functions that can fail return a
+   pseudosem_status, and leave their outputs untouched if they fail. */
+
+#include <stddef.h>
+
+#if defined(_WIN32)
+#  if defined(pseudosem_c_EXPORTS)
+#    define PSEUDOSEM_C_API __declspec(dllexport)
+#  else
+#    define PSEUDOSEM_C_API __declspec(dllimport)
+#  endif
+#elif defined(__GNUC__) || defined(__clang__)
+#  define PSEUDOSEM_C_API __attribute__((visibility("default")))
+#else
+#  define PSEUDOSEM_C_API
+#endif
+
+/* Incremented whenever the interface changes incompatibly. */
+#define PSEUDOSEM_C_ABI_VERSION 1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* A version string, which doesn't need to be null-terminated. */
+typedef struct pseudosem_string {
+    const char* data;
+    size_t length;
+} pseudosem_string;
+
+typedef enum pseudosem_status {
+    PSEUDOSEM_OK = 0,
+    /* A required pointer was null, or an array that must not be empty was. */
+    PSEUDOSEM_INVALID_ARGUMENT = 1,
+    PSEUDOSEM_OUT_OF_MEMORY = 2,
+    /* An unexpected internal error. */
+    PSEUDOSEM_ERROR = 3
+} pseudosem_status;
+
+/* A parsed version, which owns a copy of its string. */
+typedef struct pseudosem_version pseudosem_version;
+
+/* The PSEUDOSEM_C_ABI_VERSION that the library was built with. */
+PSEUDOSEM_C_API int pseudosem_abi_version(void);
+
+/* Compare two version strings, returning less than, equal to or greater
+   than zero as the first is earlier than, equivalent to or later than the
+   second. */
+PSEUDOSEM_C_API int pseudosem_compare(const char* data1, size_t length1, const char* data2, size_t length2);
+
+/* Parse a version once so that it can be compared many times. Returns null
+   if memory couldn't be allocated. Free the result with pseudosem_free. */
+PSEUDOSEM_C_API pseudosem_version* pseudosem_parse(const char* data, size_t length);
+
+/* Free a parsed version. Does nothing if version is null. */
+PSEUDOSEM_C_API void pseudosem_free(pseudosem_version* version);
+
+/* Compare two parsed versions, which must not be null, in the same way as
+   pseudosem_compare. */
+PSEUDOSEM_C_API int pseudosem_compare_parsed(const pseudosem_version* version1, const pseudosem_version* version2);
+
+/* Compare versions1[i] with versions2[i] for each i below count, writing the
+   results to results[i]. */
+PSEUDOSEM_C_API pseudosem_status pseudosem_compare_pairs(const pseudosem_string* versions1,
+                                                         const pseudosem_string* versions2,
+                                                         size_t count,
+                                                         int* results);
+
+/* Compare each of count versions with one other version, writing the
+   results to results[i]. The other version is only parsed once. */
+PSEUDOSEM_C_API pseudosem_status pseudosem_compare_each(const pseudosem_string* versions,
+                                                        size_t count,
+                                                        const char* other,
+                                                        size_t otherLength,
+                                                        int* results);
+
+/* Write the indexes of count versions to order, earliest version first,
+   keeping equivalent versions in their original order. Each version is
+   parsed once, and large arrays are sorted on up to threads threads, or one
+   per hardware thread if threads is 0. */
+PSEUDOSEM_C_API pseudosem_status pseudosem_sort(const pseudosem_string* versions,
+                                                size_t count,
+                                                unsigned threads,
+                                                size_t* order);
+
+/* Write the index of the first of the latest of count versions to index.
+   Fails with PSEUDOSEM_INVALID_ARGUMENT if count is 0. */
+PSEUDOSEM_C_API pseudosem_status pseudosem_max(const pseudosem_string* versions, size_t count, size_t* index);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,98 @@
+#include "pseudosem_c.h"
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+    std::vector<pseudosem_string> toStrings(const std::vector<std::string>& versions) {
+        std::vector<pseudosem_string> strings;
+        for (const std::string& version : versions) {
+            pseudosem_string string = { version.data(), version.size() };
+            strings.push_back(string);
+        }
+
+        return strings;
+    }
+}
+
+TEST(CApi, versionsShouldBeComparedAsStringsOrParsed) {
+    EXPECT_EQ(PSEUDOSEM_C_ABI_VERSION, pseudosem_abi_version());
+    EXPECT_GT(0, pseudosem_compare("1.0-rc.1", 8, "1.0", 3));
+    EXPECT_EQ(0, pseudosem_compare("1.0+build", 9, "1", 1));
+
+    // The string doesn't need to be null-terminated.
+    pseudosem_version* version1 = pseudosem_parse("2.0.0xyz", 5);
+    pseudosem_version* version2 = pseudosem_parse("10.0", 4);
+    ASSERT_NE(nullptr, version1);
+    ASSERT_NE(nullptr, version2);
+
+    EXPECT_GT(0, pseudosem_compare_parsed(version1, version2));
+    EXPECT_LT(0, pseudosem_compare_parsed(version2, version1));
+    EXPECT_EQ(0, pseudosem_compare_parsed(version1, version1));
+
+    pseudosem_free(version1);
+    pseudosem_free(version2);
+    pseudosem_free(nullptr);
+}
+
+TEST(CApi, batchesShouldBeCompared) {
+    std::vector<std::string> left = { "1.0", "2.0-beta", "1.10", "1.0.0" };
+    std::vector<std::string> right = { "1.1", "2.0-alpha", "1.9", "1" };
+    std::vector<pseudosem_string> versions1(toStrings(left));
+    std::vector<pseudosem_string> versions2(toStrings(right));
+
+    std::vector<int> results(left.size());
+    ASSERT_EQ(PSEUDOSEM_OK, pseudosem_compare_pairs(versions1.data(), versions2.data(), left.size(), results.data()));
+    EXPECT_GT(0, results[0]);
+    EXPECT_LT(0, results[1]);
+    EXPECT_LT(0, results[2]);
+    EXPECT_EQ(0, results[3]);
+
+    ASSERT_EQ(PSEUDOSEM_OK, pseudosem_compare_each(versions1.data(), left.size(), "1.5", 3, results.data()));
+    EXPECT_GT(0, results[0]);
+    EXPECT_LT(0, results[1]);
+    EXPECT_LT(0, results[2]);
+    EXPECT_GT(0, results[3]);
+
+    EXPECT_EQ(PSEUDOSEM_INVALID_ARGUMENT, pseudosem_compare_pairs(nullptr, versions2.data(), 1, results.data()));
+    EXPECT_EQ(PSEUDOSEM_OK, pseudosem_compare_pairs(nullptr, nullptr, 0, nullptr));
+}
+
+TEST(CApi, batchesShouldBeSortedStably) {
+    std::vector<std::string> input = { "1.10", "1.2", "1.0.0", "1.2-rc.1", "1", "0.9" };
+    std::vector<pseudosem_string> versions(toStrings(input));
+
+    for (unsigned threads = 0; threads < 3; ++threads) {
+        std::vector<size_t> order(input.size());
+        ASSERT_EQ(PSEUDOSEM_OK, pseudosem_sort(versions.data(), versions.size(), threads, order.data()));
+        EXPECT_EQ((std::vector<size_t>{ 5, 2, 4, 3, 1, 0 }), order);
+    }
+
+    std::vector<std::string> many;
+    for (size_t i = 0; i < 20000; ++i)
+        many.push_back(std::to_string((i * 7919) % 20000) + ".0");
+    std::vector<pseudosem_string> manyVersions(toStrings(many));
+    std::vector<size_t> order(many.size());
+
+    ASSERT_EQ(PSEUDOSEM_OK, pseudosem_sort(manyVersions.data(), manyVersions.size(), 4, order.data()));
+    for (size_t i = 1; i < order.size(); ++i)
+        EXPECT_GT(0, pseudosem_compare(many[order[i - 1]].data(), many[order[i - 1]].size(), many[order[i]].data(), many[order[i]].size()));
+
+    EXPECT_EQ(PSEUDOSEM_INVALID_ARGUMENT, pseudosem_sort(versions.data(), versions.size(), 0, nullptr));
+}
+
+TEST(CApi, theFirstLatestVersionShouldBeFound) {
+    std::vector<std::string> input = { "1.2", "1.10-rc.1", "1.10", "01.10.0", "1.9" };
+    std::vector<pseudosem_string> versions(toStrings(input));
+
+    size_t index = 42;
+    ASSERT_EQ(PSEUDOSEM_OK, pseudosem_max(versions.data(), versions.size(), &index));
+    EXPECT_EQ(2u, index);
+
+    index = 42;
+    EXPECT_EQ(PSEUDOSEM_INVALID_ARGUMENT, pseudosem_max(versions.data(), 0, &index));
+    EXPECT_EQ(42u, index);
+}
@@ -0,0 +1,130 @@
+#include "pseudosem/catalog.h"
+#include "pseudosem/constraint.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+    std::vector<std::string> strings(const pseudosem::VersionCatalog::Versions& versions) {
+        std::vector<std::string> result;
+        for (const pseudosem::Version& version : versions)
+            result.push_back(version.str());
+
+        return result;
+    }
+}
+
+TEST(VersionCatalog, versionsShouldBeKeptInOrderForEachPackage) {
+    pseudosem::VersionCatalog catalog;
+
+    pseudosem::VersionCatalog::Batch batch;
+    batch.push_back(std::make_pair("left-pad", "1.3.0"));
+    batch.push_back(std::make_pair("react", "18.2.0"));
+    batch.push_back(std::make_pair("left-pad", "1.0.0"));
+    batch.push_back(std::make_pair("left-pad", "1.3.0-rc.1"));
+    catalog.ingest(batch);
+
+    batch.clear();
+    batch.push_back(std::make_pair("left-pad", "1.1.0"));
+    batch.push_back(std::make_pair("left-pad", "1.3.0"));
+    batch.push_back(std::make_pair("left-pad", "2.0"));
+    batch.push_back(std::make_pair("left-pad", "1.3"));
+    catalog.ingest(batch);
+
+    pseudosem::VersionCatalog::Reader reader(catalog);
+    std::vector<std::string> expected = { "1.0.0", "1.1.0", "1.3.0-rc.1", "1.3.0", "1.3", "2.0" };
+    EXPECT_EQ(expected, strings(reader.versions("left-pad")));
+    EXPECT_EQ(std::vector<std::string>{ "18.2.0" }, strings(reader.versions("react")));
+    EXPECT_TRUE(reader.versions("lodash").empty());
+    EXPECT_EQ(2u, catalog.packages());
+}
+
+TEST(VersionCatalog, versionsShouldBeQueryable) {
+    pseudosem::VersionCatalog catalog;
+
+    pseudosem::VersionCatalog::Batch batch;
+    for (const char* version : { "1.0.0", "1.2.0", "1.2.5", "2.0.0-beta", "2.0.0", "2.1.0" })
+        batch.push_back(std::make_pair("pkg", version));
+    catalog.ingest(batch);
+
+    pseudosem::VersionCatalog::Reader reader(catalog);
+    pseudosem::VersionCatalog::Versions versions(reader.versions("pkg"));
+
+    ASSERT_NE(nullptr, versions.latest());
+    EXPECT_EQ("2.1.0", versions.latest()->str());
+
+    pseudosem::Constraint constraint("^1.2");
+    const pseudosem::Version* matching = versions.latestMatching([&constraint](const pseudosem::Version& version) {
+        return constraint.matches(version);
+    });
+    ASSERT_NE(nullptr, matching);
+    EXPECT_EQ("1.2.5", matching->str());
+
+    EXPECT_EQ(nullptr, versions.latestMatching([](const pseudosem::Version&) { return false; }));
+    EXPECT_EQ(nullptr, reader.versions("missing").latest());
+
+    EXPECT_EQ("1.2.0", versions.lowerBound(pseudosem::Version("1.2"))->str());
+    EXPECT_EQ("1.2.5", versions.upperBound(pseudosem::Version("1.2"))->str());
+    EXPECT_EQ("2.0.0-beta", versions.lowerBound(pseudosem::Version("2.0.0-alpha"))->str());
+    EXPECT_EQ(versions.end(), versions.upperBound(pseudosem::Version("3")));
+}
+
+TEST(VersionCatalog, manyPackagesShouldBeFound) {
+    pseudosem::VersionCatalog catalog;
+
+    pseudosem::VersionCatalog::Batch batch;
+    for (size_t i = 0; i < 1000; ++i)
+        batch.push_back(std::make_pair("package-" + std::to_string(i), std::to_string(i % 7) + ".0"));
+    catalog.ingest(batch);
+
+    pseudosem::VersionCatalog::Reader reader(catalog);
+    EXPECT_EQ(1000u, catalog.packages());
+    for (size_t i = 0; i < 1000; ++i) {
+        pseudosem::VersionCatalog::Versions versions(reader.versions("package-" + std::to_string(i)));
+        ASSERT_EQ(1u, versions.size());
+        EXPECT_EQ(std::to_string(i % 7) + ".0", versions.begin()->str());
+    }
+}
+
+TEST(VersionCatalog, readersShouldSeeConsistentSnapshotsWhileVersionsAreIngested) {
+    pseudosem::VersionCatalog catalog;
+    std::atomic<bool> done(false);
+    std::atomic<size_t> failures(0);
+
+    std::vector<std::thread> readers;
+    for (int t = 0; t < 4; ++t) {
+        readers.push_back(std::thread([&catalog, &done, &failures]() {
+            size_t lastSize = 0;
+
+            while (!done.load()) {
+                pseudosem::VersionCatalog::Reader reader(catalog);
+                pseudosem::VersionCatalog::Versions versions(reader.versions("pkg-" + std::to_string(lastSize % 3)));
+
+                if (!std::is_sorted(versions.begin(), versions.end()))
+                    ++failures;
+
+                lastSize = versions.size();
+            }
+        }));
+    }
+
+    for (size_t i = 0; i < 200; ++i) {
+        pseudosem::VersionCatalog::Batch batch;
+        for (size_t j = 0; j < 10; ++j)
+            batch.push_back(std::make_pair("pkg-" + std::to_string(j % 3), std::to_string((i * 37 + j * 11) % 101) + "." + std::to_string(j)));
+        batch.push_back(std::make_pair("pkg-" + std::to_string(i), "1.0"));
+
+        catalog.ingest(batch);
+    }
+
+    done = true;
+    for (std::thread& reader : readers)
+        reader.join();
+
+    EXPECT_EQ(0u, failures.load());
+    EXPECT_EQ(200u, catalog.packages());
+}
@@ -0,0 +1,117 @@
+#include "pseudosem/constraint.h"
+
+#include <gtest/gtest.h>
+
+#include <iterator>
+#include <string>
+#include <vector>
+
+TEST(Constraint, comparisonOperatorsShouldUseVersionPrecedence) {
+    EXPECT_TRUE(pseudosem::Constraint(">=1.2").matches("1.2.0"));
+    EXPECT_FALSE(pseudosem::Constraint(">1.2").matches("1.2.0"));
+    EXPECT_TRUE(pseudosem::Constraint(">1.2").matches("1.2.0a"));
+    EXPECT_TRUE(pseudosem::Constraint("<1.2").matches("1.2.0-rc.1"));
+    EXPECT_TRUE(pseudosem::Constraint("<=1.2").matches("1.2.0+build"));
+    EXPECT_FALSE(pseudosem::Constraint("<= 1.2").matches("1.2.1"));
+    EXPECT_TRUE(pseudosem::Constraint("=1.2").matches("01.2.0"));
+    EXPECT_TRUE(pseudosem::Constraint("1.2").matches("1.2.0.0"));
+    EXPECT_FALSE(pseudosem::Constraint("1.2").matches("1.2.1"));
+}
+
+TEST(Constraint, comparatorsSeparatedByWhitespaceShouldAllBeSatisfied) {
+    pseudosem::Constraint constraint(">=1.2.0 <2.0.0-0");
+
+    EXPECT_FALSE(constraint.matches("1.1.9"));
+    EXPECT_TRUE(constraint.matches("1.2.0"));
+    EXPECT_TRUE(constraint.matches("1.9.9-beta"));
+    EXPECT_FALSE(constraint.matches("2.0.0-alpha"));
+    EXPECT_FALSE(constraint.matches("2.0.0"));
+}
+
+TEST(Constraint, anyComparatorSetSeparatedByOrShouldBeSatisfied) {
+    pseudosem::Constraint constraint(">=1.2.0 <2.0.0-0 || ~3.4");
+
+    EXPECT_TRUE(constraint.matches("1.5"));
+    EXPECT_FALSE(constraint.matches("2.5"));
+    EXPECT_FALSE(constraint.matches("3.4-rc.1"));
+    EXPECT_TRUE(constraint.matches("3.4"));
+    EXPECT_TRUE(constraint.matches("3.4.99z"));
+    EXPECT_FALSE(constraint.matches("3.5-alpha"));
+    EXPECT_EQ(2u, constraint.intervals().size());
+}
+
+TEST(Constraint, tildeAndCaretShouldAllowLaterVersionsWithTheSameLeadingReleaseNumbers) {
+    EXPECT_TRUE(pseudosem::Constraint("~1.2.3").matches("1.2.9"));
+    EXPECT_FALSE(pseudosem::Constraint("~1.2.3").matches("1.3"));
+    EXPECT_TRUE(pseudosem::Constraint("~1").matches("1.9"));
+    EXPECT_FALSE(pseudosem::Constraint("~1").matches("2"));
+
+    EXPECT_TRUE(pseudosem::Constraint("^1.2.3").matches("1.9"));
+    EXPECT_FALSE(pseudosem::Constraint("^1.2.3").matches("2.0.0-0"));
+    EXPECT_TRUE(pseudosem::Constraint("^0.2.3").matches("0.2.9"));
+    EXPECT_FALSE(pseudosem::Constraint("^0.2.3").matches("0.3"));
+    EXPECT_FALSE(pseudosem::Constraint("^0.0.3").matches("0.0.4"));
+    EXPECT_TRUE(pseudosem::Constraint("^9.9").matches("9.99"));
+    EXPECT_FALSE(pseudosem::Constraint("^9.9").matches("10"));
+}
+
+TEST(Constraint, hyphenRangesAndWildcardsShouldBeSupported) {
+    EXPECT_TRUE(pseudosem::Constraint("1.0 - 2.0").matches("2.0.0"));
+    EXPECT_FALSE(pseudosem::Constraint("1.0 - 2.0").matches("2.0.1"));
+    EXPECT_TRUE(pseudosem::Constraint("*").matches("0.0.1-alpha"));
+    EXPECT_TRUE(pseudosem::Constraint("").matches("1"));
+    EXPECT_TRUE(pseudosem::Constraint("1.2.x").matches("1.2.7"));
+    EXPECT_FALSE(pseudosem::Constraint("1.x").matches("2.0"));
+    EXPECT_TRUE(pseudosem::Constraint("1.x.x").matches("1.0.0"));
+    EXPECT_TRUE(pseudosem::Constraint("1.x.x").matches("1.5.0"));
+    EXPECT_FALSE(pseudosem::Constraint("1.x.x").matches("2.0.0"));
+    EXPECT_TRUE(pseudosem::Constraint("1.*.*").matches("1.0.0"));
+    EXPECT_FALSE(pseudosem::Constraint("1.*.*").matches("0.9"));
+    EXPECT_TRUE(pseudosem::Constraint("~1.x.x").matches("1.0.0"));
+    EXPECT_FALSE(pseudosem::Constraint("~1.x.x").matches("2.0.0"));
+    EXPECT_TRUE(pseudosem::Constraint("^1.*.*").matches("1.9.9"));
+    EXPECT_TRUE(pseudosem::Constraint("^1.2.x").matches("1.5.0"));
+    EXPECT_FALSE(pseudosem::Constraint("^1.2.x").matches("1.1.9"));
+    EXPECT_FALSE(pseudosem::Constraint("^1.2.x").matches("2.0.0"));
+    EXPECT_TRUE(pseudosem::Constraint("^0.1.x").matches("0.1.9"));
+    EXPECT_FALSE(pseudosem::Constraint("^0.1.x").matches("0.2.0"));
+    EXPECT_TRUE(pseudosem::Constraint("~1.2.x").matches("1.2.9"));
+    EXPECT_FALSE(pseudosem::Constraint("~1.2.x").matches("1.3.0"));
+    EXPECT_TRUE(pseudosem::Constraint("~1.x").matches("1.9"));
+    EXPECT_FALSE(pseudosem::Constraint("~1.x").matches("2.0"));
+    EXPECT_TRUE(pseudosem::Constraint("x.x").matches("3.0"));
+}
+
+TEST(Constraint, invalidExpressionsShouldThrow) {
+    EXPECT_THROW(pseudosem::Constraint(">="), std::invalid_argument);
+    EXPECT_THROW(pseudosem::Constraint("~alpha"), std::invalid_argument);
+    EXPECT_THROW(pseudosem::Constraint(">1.x"), std::invalid_argument);
+    EXPECT_THROW(pseudosem::Constraint("1.x.2"), std::invalid_argument);
+    EXPECT_THROW(pseudosem::Constraint("~*.2"), std::invalid_argument);
+}
+
+TEST(Constraint, filterShouldCopyMatchingVersions) {
+    pseudosem::Constraint constraint("^1.0");
+    std::vector<std::string> versions;
+    versions.push_back("0.9");
+    versions.push_back("1.0");
+    versions.push_back("1.5-beta");
+    versions.push_back("2.0");
+
+    std::vector<std::string> matching;
+    constraint.filter(versions.begin(), versions.end(), std::back_inserter(matching));
+
+    ASSERT_EQ(2u, matching.size());
+    EXPECT_EQ("1.0", matching[0]);
+    EXPECT_EQ("1.5-beta", matching[1]);
+
+    std::vector<pseudosem::Version> parsed;
+    parsed.push_back(pseudosem::Version("1.1"));
+    parsed.push_back(pseudosem::Version("3"));
+
+    std::vector<pseudosem::Version> matchingParsed;
+    constraint.filter(parsed.begin(), parsed.end(), std::back_inserter(matchingParsed));
+
+    ASSERT_EQ(1u, matchingParsed.size());
+    EXPECT_EQ("1.1", matchingParsed[0].str());
+}
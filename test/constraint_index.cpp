@@ -0,0 +1,112 @@
+#include "pseudosem/constraint_index.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    std::string randomVersion(std::mt19937& random) {
+        const char* preReleases[] = { "", "", "", "-alpha", "-rc.1", "-0" };
+        return std::to_string(random() % 4) + "." + std::to_string(random() % 4) + preReleases[random() % 6];
+    }
+
+    std::string randomConstraint(std::mt19937& random) {
+        const char* operators[] = { "", ">=", ">", "<=", "<", "~", "^" };
+        std::string expression;
+
+        size_t sets = 1 + random() % 3;
+        for (size_t i = 0; i < sets; ++i) {
+            if (i > 0)
+                expression += " || ";
+
+            size_t comparators = 1 + random() % 2;
+            for (size_t j = 0; j < comparators; ++j)
+                expression += std::string(operators[random() % 7]) + randomVersion(random) + " ";
+        }
+
+        return expression;
+    }
+
+    std::vector<size_t> sorted(std::vector<size_t> ids) {
+        std::sort(ids.begin(), ids.end());
+        return ids;
+    }
+}
+
+TEST(ConstraintIndex, shouldFindTheConstraintsThatAVersionSatisfies) {
+    pseudosem::ConstraintIndex index;
+    index.insert(1, pseudosem::Constraint(">=1.0 <2.0"));
+    index.insert(2, pseudosem::Constraint("^1.5"));
+    index.insert(3, pseudosem::Constraint("~3.0 || 1.2.x"));
+    index.insert(4, pseudosem::Constraint("<1.0-0"));
+
+    EXPECT_EQ(std::vector<size_t>({ 1, 3 }), sorted(index.find("1.2.5")));
+    EXPECT_EQ(std::vector<size_t>({ 1, 2 }), sorted(index.find(pseudosem::Version("1.6"))));
+    EXPECT_EQ(std::vector<size_t>({ 4 }), index.find("0.9"));
+    EXPECT_EQ(std::vector<size_t>(), index.find("2.0"));
+    EXPECT_EQ(4u, index.size());
+}
+
+TEST(ConstraintIndex, shouldFindAConstraintOnlyOnceEvenIfItsSetsOverlap) {
+    pseudosem::ConstraintIndex index;
+    index.insert(1, pseudosem::Constraint(">=1.0 || ^1.2 || <=1.5"));
+    index.insert(1, pseudosem::Constraint("1.2"));
+
+    EXPECT_EQ(std::vector<size_t>({ 1 }), index.find("1.2"));
+}
+
+TEST(ConstraintIndex, removedConstraintsShouldNotBeFound) {
+    pseudosem::ConstraintIndex index;
+    index.insert(1, pseudosem::Constraint(">=1.0"));
+    index.insert(2, pseudosem::Constraint("<=2.0"));
+
+    EXPECT_TRUE(index.remove(1));
+    EXPECT_FALSE(index.remove(1));
+    EXPECT_EQ(std::vector<size_t>({ 2 }), index.find("1.5"));
+    EXPECT_EQ(1u, index.size());
+}
+
+TEST(ConstraintIndex, constraintsThatNothingSatisfiesShouldNotBeAdded) {
+    pseudosem::ConstraintIndex index;
+    index.insert(1, pseudosem::Constraint(">2.0 <1.0"));
+    EXPECT_EQ(0u, index.size());
+    EXPECT_FALSE(index.remove(1));
+
+    index.insert(2, pseudosem::Constraint("^1.0"));
+    index.insert(2, pseudosem::Constraint(">2.0 <1.0"));
+    EXPECT_EQ(1u, index.size());
+    EXPECT_EQ(std::vector<size_t>({ 2 }), index.find("1.5"));
+}
+
+TEST(ConstraintIndex, shouldFindTheSameConstraintsAsMatchingEachOne) {
+    std::mt19937 random(1);
+    pseudosem::ConstraintIndex index;
+    std::vector<pseudosem::Constraint> constraints;
+    std::vector<bool> removed;
+
+    for (size_t i = 0; i < 500; ++i) {
+        constraints.push_back(pseudosem::Constraint(randomConstraint(random)));
+        index.insert(i, constraints.back());
+        removed.push_back(false);
+    }
+
+    for (size_t i = 0; i < 500; i += 3) {
+        index.remove(i);
+        removed[i] = true;
+    }
+
+    for (size_t i = 0; i < 200; ++i) {
+        std::string version(randomVersion(random));
+
+        std::vector<size_t> expected;
+        for (size_t id = 0; id < constraints.size(); ++id) {
+            if (!removed[id] && constraints[id].matches(version))
+                expected.push_back(id);
+        }
+
+        EXPECT_EQ(expected, sorted(index.find(version))) << version;
+    }
+}
@@ -0,0 +1,78 @@
+#include "pseudosem/external_sort.h"
+#include "pseudosem/stream.h"
+#include "helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    std::vector<std::string> lines(const std::string& text) {
+        std::vector<std::string> result;
+        std::istringstream in(text);
+        std::string line;
+        while (std::getline(in, line))
+            result.push_back(line);
+
+        return result;
+    }
+}
+
+TEST(ExternalSorter, versionsThatFitInMemoryShouldBeSortedWithoutSpilling) {
+    std::istringstream in("1.10\n1.2\n\n1.0.0\r\n1.2-rc.1\n1\n");
+    pseudosem::ExternalSorter sorter;
+    pseudosem::reduce(in, sorter);
+    EXPECT_EQ(0u, sorter.spilledRuns());
+
+    std::ostringstream out;
+    EXPECT_EQ(5u, sorter.write(out));
+    EXPECT_EQ("1.0.0\n1\n1.2-rc.1\n1.2\n1.10\n", out.str());
+
+    std::ostringstream empty;
+    EXPECT_EQ(0u, sorter.write(empty));
+    EXPECT_EQ("", empty.str());
+}
+
+TEST(ExternalSorter, spilledRunsShouldBeMergedStably) {
+    std::vector<std::string> versions(helpers::randomVersions(5000, 7));
+
+    for (bool unique : { false, true }) {
+        pseudosem::ExternalSorter sorter(4096, unique, 2);
+        for (const std::string& ver : versions)
+            sorter.add(ver);
+        EXPECT_LT(1u, sorter.spilledRuns());
+
+        std::ostringstream out;
+        std::vector<std::string> expected(helpers::serialSort(versions, unique));
+        EXPECT_EQ(expected.size(), sorter.write(out));
+        EXPECT_EQ(expected, lines(out.str()));
+    }
+}
+
+TEST(ExternalSorter, manyRunsShouldBeMergedInLevels) {
+    // Each run holds a single version, so runs are merged in several levels.
+    std::vector<std::string> versions(helpers::randomVersions(5000, 7));
+    pseudosem::ExternalSorter sorter(1, true, 1);
+    for (const std::string& ver : versions)
+        sorter.add(ver);
+    EXPECT_GT(200u, sorter.spilledRuns());
+
+    std::ostringstream out;
+    sorter.write(out);
+    EXPECT_EQ(helpers::serialSort(versions, true), lines(out.str()));
+}
+
+TEST(ExternalSorter, versionsWithNewlinesShouldBeRejected) {
+    pseudosem::ExternalSorter sorter(1);
+    sorter.add("1.0");
+    EXPECT_THROW(sorter.add("1.2\n-rc.1"), std::invalid_argument);
+    EXPECT_THROW(sorter.add(std::string("1.1\n", 4)), std::invalid_argument);
+    sorter.add("0.9");
+
+    std::ostringstream out;
+    EXPECT_EQ(2u, sorter.write(out));
+    EXPECT_EQ("0.9\n1.0\n", out.str());
+}
@@ -0,0 +1,51 @@
+#ifndef PSEUDOSEM_TEST_HELPERS
+#define PSEUDOSEM_TEST_HELPERS
+
+#include "pseudosem.h"
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+// Helpers shared by the tests of pseudosem's sorting and indexing.
+namespace helpers {
+    // Generate a repeatable mix of versions, with different numbers of
+    // release numbers, equivalent versions and pre-releases.
+    inline std::vector<std::string> randomVersions(size_t count, unsigned seed = 1) {
+        const char* preReleases[] = { "", "-alpha", "-alpha.1", "-beta.2", "-rc.1", "-rc.01", "a", " beta" };
+        std::mt19937 random(seed);
+
+        std::vector<std::string> versions;
+        for (size_t i = 0; i < count; ++i) {
+            std::string version = std::to_string(random() % 5) + "." + std::to_string(random() % 20);
+            if (random() % 2 == 0)
+                version += "." + std::to_string(random() % 3);
+            if (random() % 4 == 0)
+                version += ".0";
+
+            version += preReleases[random() % 8];
+            versions.push_back(version);
+        }
+
+        return versions;
+    }
+
+    // Sort versions with a serial stable sort, which the other sorts must
+    // match, and optionally keep only the first of equivalent versions.
+    inline std::vector<std::string> serialSort(std::vector<std::string> versions, bool unique = false) {
+        std::stable_sort(versions.begin(), versions.end(), [](const std::string& a, const std::string& b) {
+            return pseudosem::compare(a, b) < 0;
+        });
+
+        if (unique) {
+            versions.erase(std::unique(versions.begin(), versions.end(), [](const std::string& a, const std::string& b) {
+                return pseudosem::compare(a, b) == 0;
+            }), versions.end());
+        }
+
+        return versions;
+    }
+}
+
+#endif
@@ -0,0 +1,195 @@
+#include "pseudosem/index.h"
+#include "helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // A path for the current test's index in the system's temporary
+    // directory, unique to the process so that tests can run in parallel.
+    std::string indexPath() {
+        std::string name("pseudosem_index_" + std::to_string(getpid()) + "_" +
+                         ::testing::UnitTest::GetInstance()->current_test_info()->name() + ".idx");
+
+        const char* variables[] = { "TMPDIR", "TMP", "TEMP" };
+        for (const char* variable : variables) {
+            const char* dir = std::getenv(variable);
+            if (dir != nullptr && *dir != '\0')
+                return std::string(dir) + "/" + name;
+        }
+
+#ifdef _WIN32
+        return name;
+#else
+        return "/tmp/" + name;
+#endif
+    }
+
+    void removeIndex() {
+        std::remove(indexPath().c_str());
+        std::remove((indexPath() + ".delta").c_str());
+    }
+
+    std::vector<std::string> scanAll(const pseudosem::VersionIndex& index) {
+        std::vector<std::string> result;
+        index.scan([&result](const char* ver, size_t length) { result.push_back(std::string(ver, length)); });
+        return result;
+    }
+}
+
+TEST(VersionIndex, writtenIndexesShouldBeSortedAndSearchable) {
+    removeIndex();
+    std::vector<std::string> versions(helpers::randomVersions(2000, 1));
+    versions.push_back("1.2a.123456789012345678901234567890");
+    pseudosem::VersionIndex::write(indexPath(), versions, 2);
+
+    {
+        pseudosem::VersionIndex index(indexPath());
+        EXPECT_EQ(versions.size(), index.size());
+        EXPECT_EQ(helpers::serialSort(versions), scanAll(index));
+
+        std::vector<std::string> range;
+        index.scan(pseudosem::Version("1.2"), pseudosem::Version("2.0"), [&range](const char* ver, size_t length) {
+            range.push_back(std::string(ver, length));
+        });
+
+        std::vector<std::string> expected;
+        for (const std::string& ver : helpers::serialSort(versions)) {
+            if (pseudosem::compare(ver, "1.2") >= 0 && pseudosem::compare(ver, "2.0") <= 0)
+                expected.push_back(ver);
+        }
+        EXPECT_EQ(expected, range);
+
+        std::vector<std::string> all(helpers::serialSort(versions));
+        std::string latest = index.latest();
+        EXPECT_EQ(0, pseudosem::compare(latest, all.back()));
+        EXPECT_EQ(*std::find_if(all.begin(), all.end(), [&latest](const std::string& ver) {
+            return pseudosem::compare(ver, latest) == 0;
+        }), latest);
+    }
+
+    removeIndex();
+}
+
+TEST(VersionIndex, appendedVersionsShouldBeMergedIntoTheIndex) {
+    removeIndex();
+    std::vector<std::string> versions(helpers::randomVersions(500, 2));
+    std::vector<std::string> added;
+
+    {
+        pseudosem::VersionIndex index(indexPath(), 40);
+        EXPECT_TRUE(index.empty());
+        EXPECT_EQ("", index.latest());
+
+        for (const std::string& ver : versions) {
+            if (index.append(ver))
+                added.push_back(ver);
+            EXPECT_GE(40u, index.deltaSize());
+        }
+
+        EXPECT_FALSE(index.append(versions[0]));
+        EXPECT_EQ(added.size(), index.size());
+        EXPECT_EQ(helpers::serialSort(added), scanAll(index));
+    }
+
+    // The delta is read back when the index is reopened.
+    {
+        pseudosem::VersionIndex index(indexPath(), 40);
+        EXPECT_EQ(helpers::serialSort(added), scanAll(index));
+        EXPECT_LT(0u, index.deltaSize());
+        EXPECT_TRUE(index.append("5.0-rc.1"));
+        EXPECT_EQ("5.0-rc.1", index.latest());
+
+        index.merge();
+        EXPECT_EQ(0u, index.deltaSize());
+        added.push_back("5.0-rc.1");
+        EXPECT_EQ(helpers::serialSort(added), scanAll(index));
+    }
+
+    {
+        pseudosem::VersionIndex index(indexPath());
+        EXPECT_EQ(0u, index.deltaSize());
+        EXPECT_EQ(helpers::serialSort(added), scanAll(index));
+    }
+
+    removeIndex();
+}
+
+TEST(VersionIndex, aDeltaShouldBeKeptIfTheIndexIsMissing) {
+    removeIndex();
+
+    {
+        pseudosem::VersionIndex index(indexPath());
+        EXPECT_TRUE(index.append("1.2"));
+        EXPECT_TRUE(index.append("1.10"));
+    }
+
+    std::remove(indexPath().c_str());
+
+    {
+        pseudosem::VersionIndex index(indexPath());
+        EXPECT_EQ(2u, index.deltaSize());
+        EXPECT_EQ(std::vector<std::string>({ "1.2", "1.10" }), scanAll(index));
+    }
+
+    removeIndex();
+}
+
+#ifndef _WIN32
+TEST(VersionIndex, indexesThatCantBeOpenedShouldBeLeftAlone) {
+    removeIndex();
+    std::vector<std::string> versions({ "1.0", "1.2", "2.0" });
+    pseudosem::VersionIndex::write(indexPath(), versions);
+
+    // Root can open the file anyway, so only check the constructor when
+    // it can't.
+    chmod(indexPath().c_str(), 0);
+    if (std::FILE* file = std::fopen(indexPath().c_str(), "rb"))
+        std::fclose(file);
+    else
+        EXPECT_THROW(pseudosem::VersionIndex index(indexPath()), std::runtime_error);
+
+    chmod(indexPath().c_str(), 0600);
+    {
+        pseudosem::VersionIndex index(indexPath());
+        EXPECT_EQ(versions, scanAll(index));
+    }
+
+    // A path inside a file fails to open without being missing.
+    EXPECT_THROW(pseudosem::VersionIndex index(indexPath() + "/x.idx"), std::runtime_error);
+    removeIndex();
+}
+#endif
+
+TEST(VersionIndex, filesThatArentIndexesShouldBeRejected) {
+    removeIndex();
+    std::FILE* file = std::fopen(indexPath().c_str(), "wb");
+    ASSERT_NE(nullptr, file);
+    std::fputs("1.0\n2.0\n", file);
+    std::fclose(file);
+
+    EXPECT_THROW(pseudosem::VersionIndex index(indexPath()), std::runtime_error);
+
+    pseudosem::VersionIndex::write(indexPath(), std::vector<std::string>(1, "1.0"));
+    file = std::fopen(indexPath().c_str(), "ab");
+    ASSERT_NE(nullptr, file);
+    std::fputc('x', file);
+    std::fclose(file);
+
+    EXPECT_THROW(pseudosem::VersionIndex index(indexPath()), std::runtime_error);
+    removeIndex();
+}
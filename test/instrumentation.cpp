@@ -0,0 +1,119 @@
+// Built into its own test executable, with PSEUDOSEM_INSTRUMENT defined for
+// every source file.
+#ifndef PSEUDOSEM_INSTRUMENT
+#error "PSEUDOSEM_INSTRUMENT must be defined to test instrumentation"
+#endif
+
+#include "pseudosem.h"
+#include "pseudosem/constraint.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+using pseudosem::instrumentation::Snapshot;
+
+TEST(Instrumentation, parsesShouldBeCountedWithTheirTokens) {
+    pseudosem::instrumentation::reset();
+
+    pseudosem::Version version("1.2.3-rc.1");
+    pseudosem::Version other("1.2.3a.b");
+
+    Snapshot snapshot = pseudosem::instrumentation::snapshot();
+    EXPECT_EQ(2u, snapshot.count(pseudosem::instrumentation::parses));
+    EXPECT_EQ(10u, snapshot.count(pseudosem::instrumentation::parsedTokens));
+    EXPECT_EQ(0u, snapshot.count(pseudosem::instrumentation::allocations));
+    EXPECT_LT(0u, snapshot.latencyPercentile(pseudosem::instrumentation::parseOperation, 1.0));
+    EXPECT_EQ(0u, snapshot.latencyPercentile(pseudosem::instrumentation::compareOperation, 1.0));
+
+    pseudosem::Version many("1.2.3.4.5.6.7.8");
+    snapshot = pseudosem::instrumentation::snapshot();
+    EXPECT_EQ(3u, snapshot.count(pseudosem::instrumentation::parses));
+    EXPECT_EQ(1u, snapshot.count(pseudosem::instrumentation::allocations));
+}
+
+TEST(Instrumentation, comparisonsShouldBeCountedByTheirDecidingPart) {
+    pseudosem::instrumentation::reset();
+
+    EXPECT_GT(0, pseudosem::compare(std::string("1.2"), std::string("1.10")));
+    EXPECT_GT(0, pseudosem::compare(std::string("1.0"), std::string("1.0a")));
+    EXPECT_GT(0, pseudosem::compare(std::string("1.0-alpha"), std::string("1.0-beta")));
+    EXPECT_EQ(0, pseudosem::compare(std::string("1.0"), std::string("1")));
+    EXPECT_LT(0, pseudosem::Version("2.0").compare(pseudosem::Version("1.0")));
+    EXPECT_LT(0, pseudosem::Version("1.0").compare(pseudosem::Version("1.0-rc")));
+
+    Snapshot snapshot = pseudosem::instrumentation::snapshot();
+    EXPECT_EQ(6u, snapshot.count(pseudosem::instrumentation::compares));
+    EXPECT_EQ(2u, snapshot.count(pseudosem::instrumentation::decidedByReleaseNumbers));
+    EXPECT_EQ(1u, snapshot.count(pseudosem::instrumentation::decidedByReleaseStrings));
+    EXPECT_EQ(2u, snapshot.count(pseudosem::instrumentation::decidedByPreRelease));
+    EXPECT_EQ(1u, snapshot.count(pseudosem::instrumentation::equivalentComparisons));
+
+    // Only comparisons of strings are timed.
+    EXPECT_LT(0u, snapshot.latencyPercentile(pseudosem::instrumentation::compareOperation, 0.5));
+    uint64_t timed = 0;
+    for (uint64_t count : snapshot.latencies[pseudosem::instrumentation::compareOperation])
+        timed += count;
+    EXPECT_EQ(4u, timed);
+}
+
+TEST(Instrumentation, exceptionsShouldBeCounted) {
+    pseudosem::instrumentation::reset();
+
+    EXPECT_THROW(pseudosem::Constraint("<x"), std::invalid_argument);
+    EXPECT_EQ(1u, pseudosem::instrumentation::snapshot().count(pseudosem::instrumentation::exceptions));
+}
+
+TEST(Instrumentation, countersOfAllThreadsShouldBeAddedUp) {
+    pseudosem::instrumentation::reset();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.push_back(std::thread([]() {
+            for (int i = 0; i < 1000; ++i)
+                pseudosem::compare(std::string("1.0.") + std::to_string(i), std::string("1.0"));
+        }));
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    // The threads have exited, but their counts are kept.
+    Snapshot snapshot = pseudosem::instrumentation::snapshot();
+    EXPECT_EQ(4000u, snapshot.count(pseudosem::instrumentation::compares));
+    EXPECT_EQ(3996u, snapshot.count(pseudosem::instrumentation::decidedByReleaseNumbers));
+    EXPECT_EQ(4u, snapshot.count(pseudosem::instrumentation::equivalentComparisons));
+
+    pseudosem::instrumentation::reset();
+    EXPECT_EQ(0u, pseudosem::instrumentation::snapshot().count(pseudosem::instrumentation::compares));
+}
+
+TEST(Instrumentation, resetShouldBeSafeWhileOtherThreadsCount) {
+    std::atomic<uint64_t> done(0);
+    std::atomic<bool> stop(false);
+
+    std::thread thread([&done, &stop]() {
+        while (!stop) {
+            pseudosem::compare(std::string("1.0"), std::string("1.1"));
+            ++done;
+        }
+    });
+
+    for (int i = 0; i < 100; ++i) {
+        while (done < 1000u * (i + 1))
+            std::this_thread::yield();
+
+        // At most one comparison can be in progress during the reset.
+        uint64_t before = done;
+        pseudosem::instrumentation::reset();
+        uint64_t counted = pseudosem::instrumentation::snapshot().count(pseudosem::instrumentation::compares);
+        uint64_t after = done;
+        EXPECT_GE(after - before + 1, counted);
+    }
+
+    stop = true;
+    thread.join();
+}
@@ -0,0 +1,99 @@
+#include "pseudosem/interner.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(VersionInterner, internedStringsShouldGetTheSameIdEachTime) {
+    pseudosem::VersionInterner interner;
+
+    pseudosem::VersionInterner::Id id1 = interner.intern("1.0.0");
+    pseudosem::VersionInterner::Id id2 = interner.intern("2.0.0");
+
+    EXPECT_NE(id1, id2);
+    EXPECT_EQ(id1, interner.intern("1.0.0"));
+    EXPECT_EQ("2.0.0", interner.version(id2).str());
+    EXPECT_EQ(2u, interner.size());
+
+    pseudosem::VersionInterner::Id found = 0;
+    EXPECT_TRUE(interner.find("2.0.0", found));
+    EXPECT_EQ(id2, found);
+    EXPECT_FALSE(interner.find("3.0.0", found));
+}
+
+TEST(VersionInterner, equivalentVersionsShouldHaveDifferentIdsButCompareEqual) {
+    pseudosem::VersionInterner interner;
+
+    pseudosem::VersionInterner::Id id1 = interner.intern("1.0");
+    pseudosem::VersionInterner::Id id2 = interner.intern("1.0.0+build");
+
+    EXPECT_NE(id1, id2);
+    EXPECT_EQ(0, interner.compare(id1, id2));
+    EXPECT_EQ(interner.orderKey(id1), interner.orderKey(id2));
+}
+
+TEST(VersionInterner, comparisonsShouldMatchVersionComparisonsWhenKeysRunOut) {
+    pseudosem::VersionInterner interner;
+    std::vector<std::string> versions;
+    versions.push_back("0");
+    versions.push_back("1");
+
+    // Each version is inserted just above "0", halving the gap between
+    // keys each time.
+    for (int i = 200; i > 0; --i)
+        versions.push_back("0." + std::to_string(i));
+    versions.push_back("0.100-alpha");
+    versions.push_back("2");
+
+    std::vector<pseudosem::VersionInterner::Id> ids;
+    for (const std::string& version : versions)
+        ids.push_back(interner.intern(version));
+
+    for (size_t i = 0; i < ids.size(); ++i) {
+        for (size_t j = 0; j < ids.size(); ++j) {
+            int expected = pseudosem::compare(versions[i], versions[j]);
+            int actual = interner.compare(ids[i], ids[j]);
+
+            EXPECT_EQ(expected < 0, actual < 0) << versions[i] << " vs " << versions[j];
+            EXPECT_EQ(expected == 0, actual == 0) << versions[i] << " vs " << versions[j];
+            EXPECT_EQ(expected < 0, interner.orderKey(ids[i]) < interner.orderKey(ids[j]));
+        }
+    }
+}
+
+TEST(VersionInterner, shouldBeUsableFromManyThreads) {
+    pseudosem::VersionInterner interner;
+    std::vector<std::thread> threads;
+    std::vector<int> mismatches(4, 0);
+
+    for (unsigned t = 0; t < 4; ++t) {
+        threads.push_back(std::thread([&interner, &mismatches, t]() {
+            std::mt19937 random(t);
+            pseudosem::VersionInterner::Id previous = interner.intern("0");
+            std::string previousString("0");
+
+            for (size_t i = 0; i < 2000; ++i) {
+                std::string version = std::to_string(random() % 5) + "." + std::to_string(random() % 50);
+                pseudosem::VersionInterner::Id id = interner.intern(version);
+
+                int expected = pseudosem::compare(version, previousString);
+                int actual = interner.compare(id, previous);
+                if ((expected < 0) != (actual < 0) || (expected == 0) != (actual == 0))
+                    mismatches[t] = 1;
+
+                previous = id;
+                previousString = version;
+            }
+        }));
+    }
+
+    for (std::thread& thread : threads)
+        thread.join();
+
+    for (int mismatch : mismatches)
+        EXPECT_EQ(0, mismatch);
+    EXPECT_GE(251u, interner.size());
+}
@@ -2,6 +2,12 @@
 
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <cstring>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
 TEST(Basic, anEmptyStringShouldBeEqualToAVersionOfZero) {
     std::string version1;
     std::string version2("0");
@@ -334,6 +340,322 @@ TEST(Extended, versionsShouldBeComparedCaseInsensitively) {
     EXPECT_LT(0, pseudosem::compare(version2, version1));
 }
 
+TEST(Extended, versionsDifferingOnlyInCaseShouldBeEquivalent) {
+    EXPECT_EQ(0, pseudosem::compare(std::string("1.0.0-ALPHA.1"), std::string("1.0.0-alpha.1")));
+    EXPECT_EQ(0, pseudosem::compare("1.0.0RC", "1.0.0rc"));
+    EXPECT_EQ(0, pseudosem::Version("1.0-Beta").compare(pseudosem::Version("1.0-bEtA")));
+    EXPECT_EQ(pseudosem::sortKey("1.0.0-ALPHA.1"), pseudosem::sortKey("1.0.0-alpha.1"));
+
+    // Letters are folded before comparison, so upper case letters sort
+    // after characters between "Z" and "a".
+    EXPECT_GT(0, pseudosem::compare("1.0-^", "1.0-A"));
+    EXPECT_LT(pseudosem::sortKey("1.0-^"), pseudosem::sortKey("1.0-A"));
+}
+
+TEST(Extended, releaseStringsWithNoLeadingDigitsShouldBeGreaterThanTheReleaseNumbersAlone) {
+    std::string version1, version2;
+
+    version1 = std::string("1.0");
+    version2 = std::string("1.0.a");
+    EXPECT_GT(0, pseudosem::compare(version1, version2));
+    EXPECT_LT(0, pseudosem::compare(version2, version1));
+
+    version1 = std::string("1.0.a");
+    version2 = std::string("1.0a");
+    EXPECT_EQ(0, pseudosem::compare(version1, version2));
+    EXPECT_EQ(0, pseudosem::compare(version2, version1));
+}
+
+TEST(Extended, versionsWithManyPartsShouldBeCompared) {
+    std::string version1, version2;
+
+    version1 = std::string("1.2.3.4.5.6.7.8.9-a.b.c.d.e.f.1");
+    version2 = std::string("1.2.3.4.5.6.7.8.9-a.b.c.d.e.f.2");
+    EXPECT_GT(0, pseudosem::compare(version1, version2));
+    EXPECT_LT(0, pseudosem::compare(version2, version1));
+}
+
+TEST(Extended, numbersTooLargeForIntegersShouldBeComparedByValue) {
+    const char* versions[] = {
+        "18446744073709551615",
+        "018446744073709551616",
+        "18446744073709551616.1",
+        "99999999999999999999",
+        "100000000000000000000",
+        "1.0-99999999999999999999999999",
+        "1.0-100000000000000000000000000",
+        "1.0-a",
+    };
+
+    for (size_t i = 0; i < sizeof(versions) / sizeof(versions[0]); ++i) {
+        for (size_t j = 0; j < sizeof(versions) / sizeof(versions[0]); ++j) {
+            // The pre-releases of 1.0 are all earlier than the other versions.
+            bool isPreRelease1 = std::string(versions[i]).find('-') != std::string::npos;
+            bool isPreRelease2 = std::string(versions[j]).find('-') != std::string::npos;
+            bool expectedLess = isPreRelease1 != isPreRelease2 ? isPreRelease1 : i < j;
+            bool expectedEqual = i == j;
+
+            EXPECT_EQ(expectedLess, pseudosem::compare(std::string(versions[i]), std::string(versions[j])) < 0) << versions[i] << " vs " << versions[j];
+            EXPECT_EQ(expectedEqual, pseudosem::compare(std::string(versions[i]), std::string(versions[j])) == 0) << versions[i] << " vs " << versions[j];
+            EXPECT_EQ(expectedLess, pseudosem::compare(versions[i], versions[j]) < 0) << versions[i] << " vs " << versions[j];
+            EXPECT_EQ(expectedLess, pseudosem::sortKey(versions[i]) < pseudosem::sortKey(versions[j])) << versions[i] << " vs " << versions[j];
+        }
+    }
+
+    EXPECT_EQ(0, pseudosem::compare("00000000000000000000000000001.0", "1"));
+    EXPECT_EQ(pseudosem::sortKey("00000000000000000000000000001.0"), pseudosem::sortKey("1"));
+}
+
+TEST(Overloads, cStringsShouldBeComparedInTheSameWayAsStdStrings) {
+    EXPECT_EQ(0, pseudosem::compare("1.0", "1.0.0"));
+    EXPECT_GT(0, pseudosem::compare("1.0.0-alpha", "1.0.0"));
+    EXPECT_LT(0, pseudosem::compare(std::string("1.0.1"), "1.0.0"));
+}
+
+#ifdef PSEUDOSEM_HAS_CONSTEXPR
+static_assert(pseudosem::compare("1.4.0-rc.1", "1.4.0") < 0, "Pre-releases should be earlier");
+static_assert(pseudosem::compare("1.0", "01.0.0+build") == 0, "Padding and metadata should be ignored");
+static_assert(pseudosem::compare("1.0.0a", "1.0.0-beta.11") > 0, "Release strings should be later");
+static_assert(pseudosem::compare("0.0.1-beta.2", "0.0.1-beta.11") < 0, "Numbers should be compared by value");
+#endif
+
+TEST(Overloads, inPlaceComparisonShouldMatchParsedComparison) {
+    const char* versions[] = {
+        "", "0", "1", "1.0", "1.0.0.1", "01.2", "1.2-", "1.2-0", "1.2-alpha",
+        "1.2-alpha.1", "1.2 alpha:1", "1.2-1.alpha", "1.2a", "1.2.a", "1.2a.5",
+        "1.2b", "1.2+build", "1.2-beta+build", "-alpha", ".1", "1..2",
+    };
+
+    for (const char* version1 : versions) {
+        for (const char* version2 : versions) {
+            int expected = pseudosem::Version(version1).compare(pseudosem::Version(version2));
+            int actual = pseudosem::compare(version1, version2);
+
+            EXPECT_EQ(expected < 0, actual < 0) << version1 << " vs " << version2;
+            EXPECT_EQ(expected == 0, actual == 0) << version1 << " vs " << version2;
+        }
+    }
+}
+
+#ifdef PSEUDOSEM_HAS_CONSTEXPR
+static_assert(pseudosem::compare<pseudosem::StrictSemVer>("1.4.0-rc.1", 10, "1.4.0", 5) < 0, "Pre-releases should be earlier");
+static_assert(pseudosem::compare<pseudosem::StrictSemVer>("1.10", 4, "1.9.9", 5) > 0, "Numbers should be compared by value");
+#endif
+
+TEST(Overloads, policiesShouldNotChangeComparisons) {
+    const char* versions[] = {
+        "", "0", "0.0.0", "1", "1.0", "1.0.0", "1.0.0.0", "1.0.0.1", "1.2.3", "01.02.03", "1.2.3-", "1.2.3-rc.1",
+        "1.2.3-rc.2", "1.2.3-RC.10", "1.2.3_rc", "1.2.3+build", "1.2.3-rc+build", "1.2.3a", "1.2.3.a", "1..2",
+        "1.2.", ".1", "1.2-3", "1.2.3 4", "9999999999999999999.1", "10000000000000000000", "0000000000000000000001.2",
+    };
+
+    for (const char* version1 : versions) {
+        for (const char* version2 : versions) {
+            int expected = pseudosem::compare(version1, version2);
+            int strict = pseudosem::compare<pseudosem::StrictSemVer>(std::string(version1), std::string(version2));
+            int any = pseudosem::compare<pseudosem::AnyVersions>(version1, std::strlen(version1), version2, std::strlen(version2));
+
+            EXPECT_EQ(expected < 0, strict < 0) << version1 << " vs " << version2;
+            EXPECT_EQ(expected == 0, strict == 0) << version1 << " vs " << version2;
+            EXPECT_EQ(expected, any);
+        }
+    }
+}
+
+TEST(Tokenizer, simdClassifiersShouldMatchTheScalarClassifier) {
+    std::string block;
+    for (int i = 0; i < 64; ++i)
+        block += "0129.-_ :+aZ/\x80\xff"[(i * 7) % 16];
+
+    for (size_t size = 0; size <= 64; ++size) {
+        pseudosem::detail::CharClasses expected = pseudosem::detail::classifyScalar(block.data(), size);
+        std::vector<pseudosem::detail::CharClasses> actual;
+
+#ifdef PSEUDOSEM_HAS_SSE2
+        actual.push_back(pseudosem::detail::classifySse2(block.data(), size));
+#endif
+#ifdef PSEUDOSEM_HAS_AVX2
+        if (pseudosem::detail::hasAvx2())
+            actual.push_back(pseudosem::detail::classifyAvx2(block.data(), size));
+#endif
+
+        for (const pseudosem::detail::CharClasses& classes : actual) {
+            EXPECT_EQ(expected.dots, classes.dots) << size;
+            EXPECT_EQ(expected.separators, classes.separators) << size;
+            EXPECT_EQ(expected.digits, classes.digits) << size;
+            EXPECT_EQ(expected.plus, classes.plus) << size;
+        }
+    }
+}
+
+TEST(Tokenizer, tokensShouldBeFoundAcrossBlockBoundaries) {
+    std::vector<std::string> versions;
+    for (size_t length = 60; length < 140; ++length) {
+        std::string version;
+        for (size_t i = 0; version.size() < length; ++i)
+            version += std::to_string(i % 7) + (i % 11 == 10 ? "a" : "") + (i == 20 ? "-" : ".");
+
+        versions.push_back(version.substr(0, length));
+        versions.push_back(version.substr(0, length) + "+build");
+    }
+
+    for (const std::string& version1 : versions) {
+        for (const std::string& version2 : versions) {
+            int expected = pseudosem::compare(version1, version2);
+            int actual = pseudosem::Version(version1).compare(pseudosem::Version(version2));
+
+            EXPECT_EQ(expected < 0, actual < 0) << version1 << " vs " << version2;
+            EXPECT_EQ(expected == 0, actual == 0) << version1 << " vs " << version2;
+        }
+    }
+}
+
+TEST(Version, shouldCompareInTheSameWayAsStrings) {
+    pseudosem::Version version1("1.0.0-alpha");
+    pseudosem::Version version2("1.0");
+
+    EXPECT_GT(0, version1.compare(version2));
+    EXPECT_LT(0, version2.compare(version1));
+    EXPECT_TRUE(version1 < version2);
+    EXPECT_TRUE(version1 <= version2);
+    EXPECT_TRUE(version2 > version1);
+    EXPECT_TRUE(version2 >= version1);
+    EXPECT_TRUE(version1 != version2);
+    EXPECT_TRUE(pseudosem::Version("1.0") == pseudosem::Version("1.0.0+build"));
+    EXPECT_TRUE(pseudosem::Version() == pseudosem::Version("0"));
+}
+
+TEST(Version, copiesAndMovesShouldStillCompareCorrectly) {
+    // Use a string that's too long for the small string optimisation too.
+    std::string longString("1.0.0-alpha.beta.gamma.delta.epsilon.zeta.eta.theta");
+    pseudosem::Version original(longString);
+    pseudosem::Version shortOriginal("1.0.0-a");
+
+    pseudosem::Version copy(original);
+    pseudosem::Version shortCopy(shortOriginal);
+    EXPECT_EQ(0, copy.compare(original));
+    EXPECT_EQ(0, shortCopy.compare(shortOriginal));
+    EXPECT_EQ(longString, copy.str());
+
+    pseudosem::Version moved(std::move(copy));
+    pseudosem::Version shortMoved(std::move(shortCopy));
+    EXPECT_EQ(0, moved.compare(original));
+    EXPECT_EQ(0, shortMoved.compare(shortOriginal));
+
+    copy = moved;
+    shortCopy = std::move(shortMoved);
+    EXPECT_EQ(0, copy.compare(original));
+    EXPECT_EQ(0, shortCopy.compare(shortOriginal));
+    EXPECT_GT(0, shortCopy.compare(copy));
+}
+
+TEST(Version, shouldBeUsableInStandardContainers) {
+    std::vector<pseudosem::Version> versions;
+    versions.push_back(pseudosem::Version("1.0.0"));
+    versions.push_back(pseudosem::Version("1.0.0-rc.1"));
+    versions.push_back(pseudosem::Version("0.9"));
+    versions.push_back(pseudosem::Version("1.0.0-beta"));
+
+    std::sort(versions.begin(), versions.end());
+
+    ASSERT_EQ(4u, versions.size());
+    EXPECT_EQ("0.9", versions[0].str());
+    EXPECT_EQ("1.0.0-beta", versions[1].str());
+    EXPECT_EQ("1.0.0-rc.1", versions[2].str());
+    EXPECT_EQ("1.0.0", versions[3].str());
+
+    std::set<pseudosem::Version> set(versions.begin(), versions.end());
+    set.insert(pseudosem::Version("1.0.0.0"));
+    EXPECT_EQ(4u, set.size());
+}
+
+TEST(SortKey, shouldSortInTheSameOrderAsVersions) {
+    const char* versions[] = {
+        "", "0", "0.0.0", "0.0.1", "0.0.01", "0.0.2", "0.0.10", "0.1", "0.1.0.0",
+        "1", "1.0.0.0.0", "1.0.0.1", "1.0.1", "1.1", "2", "10", "256", "255.1",
+        "65536", "1.0-", "1.0.0-0", "1.0.0-1", "1.0.0-01", "1.0.0-1.alpha",
+        "1.0.0-2", "1.0.0-alpha", "1.0.0-alpha.1", "1.0.0-alpha.beta",
+        "1.0.0-beta", "1.0.0-beta.2", "1.0.0-beta.11", "1.0.0-rc.1",
+        "1.0.0+build", "1.0.0 alpha:1-2_3", "1.0.0a", "1.0.0a.5", "1.0.0b",
+        "1.0.a", "1.0a-alpha", "1.0.0alpha.2", "1.0.0beta", "1.0.0-Alpha",
+        "1.0.0A", "1.0.0-a", "1.0.0-ab", "1.0.0-b",
+    };
+
+    for (const char* version1 : versions) {
+        for (const char* version2 : versions) {
+            int expected = pseudosem::compare(version1, version2);
+            int actual = pseudosem::sortKey(version1).compare(pseudosem::sortKey(version2));
+
+            EXPECT_EQ(expected < 0, actual < 0) << version1 << " vs " << version2;
+            EXPECT_EQ(expected == 0, actual == 0) << version1 << " vs " << version2;
+        }
+    }
+}
+
+TEST(SortKey, shouldHandleNullBytesInStrings) {
+    std::string version1("1.0.0-a", 7);
+    std::string version2("1.0.0-a\0", 8);
+    std::string version3("1.0.0-a\0b", 9);
+
+    EXPECT_GT(0, pseudosem::sortKey(version1).compare(pseudosem::sortKey(version2)));
+    EXPECT_GT(0, pseudosem::sortKey(version2).compare(pseudosem::sortKey(version3)));
+    EXPECT_EQ(pseudosem::sortKey(version3), pseudosem::Version(version3).sortKey());
+}
+
+TEST(Canonical, equivalentVersionsShouldHaveTheSameCanonicalForm) {
+    EXPECT_EQ("1", pseudosem::canonical("1.0"));
+    EXPECT_EQ("1", pseudosem::canonical("1.0.0.0"));
+    EXPECT_EQ("1", pseudosem::canonical("01.0.0"));
+    EXPECT_EQ("1", pseudosem::canonical("1.0.0+build5"));
+    EXPECT_EQ("0", pseudosem::canonical(""));
+    EXPECT_EQ("1.0.2", pseudosem::canonical("1.00.02"));
+    EXPECT_EQ("1-rc.1", pseudosem::canonical("1.0.0-RC.01"));
+    EXPECT_EQ("1-alpha.1.2.3", pseudosem::canonical("1.0.0 alpha:1-2_3"));
+    EXPECT_EQ("1-0", pseudosem::canonical("1.0-"));
+    EXPECT_EQ("1.a.5", pseudosem::canonical("1.0A.05"));
+    EXPECT_EQ("0.beta", pseudosem::canonical("beta"));
+    EXPECT_EQ("1.2-x", pseudosem::Version("1.2.0-X").canonical());
+}
+
+TEST(Canonical, canonicalFormsAndHashesShouldBeConsistentWithComparison) {
+    const char* versions[] = {
+        "", "0", "1", "1.0", "1.0.0.0", "01.0.0", "1.0.0+build5", "1.0.1",
+        "1.0-", "1.0-0", "1.0-00", "1.0-alpha", "1.0-ALPHA", "1.0 alpha",
+        "1.0-alpha.1", "1.0-alpha.01", "1.0a", "1.0.a", "1a", "1.0A.5",
+        "1.0a.05", "a", "0.a", "1.2.3-rc.1+build", "1.2.3_RC:1",
+        "18446744073709551616", "018446744073709551616.0",
+    };
+
+    for (const char* version1 : versions) {
+        std::string canonical1 = pseudosem::canonical(version1);
+        EXPECT_EQ(0, pseudosem::compare(version1, canonical1.c_str())) << version1;
+        EXPECT_EQ(canonical1, pseudosem::canonical(canonical1)) << version1;
+
+        for (const char* version2 : versions) {
+            bool isEqual = pseudosem::compare(version1, version2) == 0;
+
+            EXPECT_EQ(isEqual, canonical1 == pseudosem::canonical(version2)) << version1 << " vs " << version2;
+            if (isEqual) {
+                EXPECT_EQ(pseudosem::hash(std::string(version1)), pseudosem::hash(std::string(version2))) << version1 << " vs " << version2;
+            }
+        }
+    }
+}
+
+TEST(Canonical, versionsShouldBeUsableInUnorderedContainers) {
+    std::unordered_set<pseudosem::Version> versions;
+    versions.insert(pseudosem::Version("1.0"));
+    versions.insert(pseudosem::Version("1.0.0.0"));
+    versions.insert(pseudosem::Version("01.0.0+build5"));
+    versions.insert(pseudosem::Version("1.0-RC.1"));
+    versions.insert(pseudosem::Version("1.0.0-rc.1"));
+    versions.insert(pseudosem::Version("1.0.1"));
+
+    EXPECT_EQ(3u, versions.size());
+    EXPECT_EQ(1u, versions.count(pseudosem::Version("1")));
+    EXPECT_EQ(pseudosem::hash("1.0.0"), std::hash<pseudosem::Version>()(pseudosem::Version("1")));
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
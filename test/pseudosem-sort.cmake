@@ -0,0 +1,55 @@
+# Tests for the pseudosem-sort tool's line handling. Run with
+# cmake -DTOOL=<path to pseudosem-sort> -DWORK_DIR=<scratch dir> -P pseudosem-sort.cmake
+
+if (NOT TOOL OR NOT WORK_DIR)
+    message (FATAL_ERROR "TOOL and WORK_DIR must be set")
+endif ()
+
+set (failures 0)
+
+# Sort the input with the given arguments, and check the output.
+function (check name input expected)
+    set (path "${WORK_DIR}/pseudosem-sort-${name}.txt")
+    file (WRITE "${path}" "${input}")
+
+    # Compare the output as hex, since CMake drops carriage returns when
+    # reading text.
+    execute_process (COMMAND "${TOOL}" ${ARGN} "${path}"
+                     OUTPUT_FILE "${path}.out"
+                     ERROR_VARIABLE error
+                     RESULT_VARIABLE result)
+    file (READ "${path}.out" outputHex HEX)
+    file (READ "${path}.out" output)
+    file (REMOVE "${path}" "${path}.out")
+    string (HEX "${expected}" expectedHex)
+
+    if (NOT result EQUAL 0 OR NOT outputHex STREQUAL expectedHex)
+        message ("FAILED ${name}: pseudosem-sort ${ARGN} exited with ${result}\n${error}"
+                 "expected:\n${expected}got:\n${output}")
+        math (EXPR count "${failures} + 1")
+        set (failures ${count} PARENT_SCOPE)
+    endif ()
+endfunction ()
+
+check (plain "1.10\n1.2\n1.2-rc.1\n1.9\n" "1.2-rc.1\n1.2\n1.9\n1.10\n")
+
+# Equivalent versions keep their input order, and -u keeps the first.
+check (stable "1.2.0\n1.2\n1.1\n1.2.0.0\n" "1.1\n1.2.0\n1.2\n1.2.0.0\n")
+check (unique "1.2.0\n1.2\n1.1\n1.2.0.0\n" "1.1\n1.2.0\n" -u)
+
+# -r reverses versions, but not lines with equivalent versions.
+check (reverse "1.2.0\n1.10\n1.2\n1.1\n" "1.10\n1.2.0\n1.2\n1.1\n" -r)
+check (unique-reverse "1.2.0\n1.10\n1.2\n1.1\n" "1.10\n1.2.0\n1.1\n" -u -r)
+
+# -k sorts by a field, and -t changes the delimiter. Lines missing the
+# field sort as empty versions.
+check (key "b\t1.10\na\t1.2\nc\t1.9\n" "a\t1.2\nc\t1.9\nb\t1.10\n" -k 2)
+check (delimiter "b,1.10,x\na,1.2,y\nc,1.9,z\nd\n" "d\na,1.2,y\nc,1.9,z\nb,1.10,x\n" -k 2 -t ,)
+check (key-reverse "b,1.10\na,1.2\nc,1.2.0\n" "b,1.10\na,1.2\nc,1.2.0\n" -r -k 2 -t ,)
+
+# Windows line endings aren't part of the version, but are kept.
+check (crlf "1.10\r\n1.2\r\n" "1.2\r\n1.10\r\n")
+
+if (failures GREATER 0)
+    message (FATAL_ERROR "${failures} pseudosem-sort tests failed")
+endif ()
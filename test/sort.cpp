@@ -0,0 +1,63 @@
+#include "pseudosem/sort.h"
+#include "helpers.h"
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+namespace {
+    struct Package {
+        std::string name;
+        std::string version;
+    };
+}
+
+TEST(Sort, shouldSortInTheSameOrderAsASerialStableSort) {
+    std::vector<std::string> versions(helpers::randomVersions(20000));
+    std::vector<std::string> expected(helpers::serialSort(versions));
+
+    pseudosem::sort(versions.begin(), versions.end());
+
+    EXPECT_EQ(expected, versions);
+}
+
+TEST(Sort, resultShouldNotDependOnTheNumberOfThreads) {
+    std::vector<std::string> versions(helpers::randomVersions(20000));
+    std::vector<std::string> expected(helpers::serialSort(versions));
+    auto projection = [](const std::string& version) -> const std::string& { return version; };
+
+    for (unsigned threads = 1; threads <= 7; ++threads) {
+        std::vector<std::string> sorted(versions);
+        pseudosem::stable_sort(sorted.begin(), sorted.end(), projection, threads);
+        EXPECT_EQ(expected, sorted) << threads << " threads";
+    }
+}
+
+TEST(Sort, shouldSortRecordsByProjectedVersion) {
+    std::vector<Package> packages;
+    packages.push_back(Package{ "a", "1.0.0" });
+    packages.push_back(Package{ "b", "1.0.0-rc.1" });
+    packages.push_back(Package{ "c", "1.0" });
+    packages.push_back(Package{ "d", "0.9" });
+
+    pseudosem::stable_sort(packages.begin(), packages.end(), [](const Package& package) -> const std::string& {
+        return package.version;
+    });
+
+    ASSERT_EQ(4u, packages.size());
+    EXPECT_EQ("d", packages[0].name);
+    EXPECT_EQ("b", packages[1].name);
+    EXPECT_EQ("a", packages[2].name);
+    EXPECT_EQ("c", packages[3].name);
+}
+
+TEST(Sort, shouldSortCStrings) {
+    const char* versions[] = { "1.0", "1.0-alpha", "0.1" };
+
+    pseudosem::sort(std::begin(versions), std::end(versions));
+
+    EXPECT_STREQ("0.1", versions[0]);
+    EXPECT_STREQ("1.0-alpha", versions[1]);
+    EXPECT_STREQ("1.0", versions[2]);
+}
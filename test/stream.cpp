@@ -0,0 +1,74 @@
+#include "pseudosem/stream.h"
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+TEST(Stream, latestAndEarliestVersionsShouldBeKept) {
+    std::istringstream in("1.0\n2.0-rc.1\r\n\n1.5\n2.0-beta\n0.9.9\n");
+    pseudosem::LatestVersion latest;
+    pseudosem::EarliestVersion earliest;
+
+    EXPECT_TRUE(latest.empty());
+    EXPECT_THROW(latest.version(), std::logic_error);
+
+    pseudosem::reduce(in, latest);
+    in.clear();
+    in.seekg(0);
+    pseudosem::reduce(in, earliest);
+
+    EXPECT_FALSE(latest.empty());
+    EXPECT_EQ("2.0-rc.1", latest.version().str());
+    EXPECT_EQ("0.9.9", earliest.version().str());
+}
+
+TEST(Stream, theFirstOfEquivalentVersionsShouldBeKept) {
+    pseudosem::LatestVersion latest;
+    latest.add("1.0");
+    latest.add("1.0.0");
+
+    EXPECT_EQ("1.0", latest.version().str());
+}
+
+TEST(Stream, latestVersionsShouldBeKeptLatestFirst) {
+    std::istringstream in("1.0\n3.0\n2.0\n0.1\n2.5\n2.5-alpha\n");
+    pseudosem::LatestVersions latest(3);
+    pseudosem::reduce(in, latest);
+
+    std::vector<pseudosem::Version> versions(latest.versions());
+    ASSERT_EQ(3u, versions.size());
+    EXPECT_EQ("3.0", versions[0].str());
+    EXPECT_EQ("2.5", versions[1].str());
+    EXPECT_EQ("2.5-alpha", versions[2].str());
+
+    pseudosem::LatestVersions none(0);
+    none.add("1.0");
+    EXPECT_TRUE(none.versions().empty());
+}
+
+TEST(Stream, versionsShouldBeCountedByLeadingReleaseNumbers) {
+    std::istringstream in("1\n1.0.5\n1.2-beta\n01.2.3\n2.0\n");
+    pseudosem::ReleaseCounts counts(2);
+    pseudosem::reduce(in, counts);
+
+    pseudosem::ReleaseCounts::Counts expected;
+    expected[{ "1", "0" }] = 2;
+    expected[{ "1", "2" }] = 2;
+    expected[{ "2", "0" }] = 1;
+    EXPECT_EQ(expected, counts.counts());
+}
+
+TEST(Stream, releaseNumbersTooLargeForIntegersShouldBeCountedInOrder) {
+    std::istringstream in("20231017120000123456789.1\n9.0\n020231017120000123456789\n18446744073709551616\n");
+    pseudosem::ReleaseCounts counts(1);
+    pseudosem::reduce(in, counts);
+
+    std::vector<std::pair<std::vector<std::string>, size_t>> actual(counts.counts().begin(), counts.counts().end());
+    ASSERT_EQ(3u, actual.size());
+    EXPECT_EQ(std::vector<std::string>{ "9" }, actual[0].first);
+    EXPECT_EQ(std::vector<std::string>{ "18446744073709551616" }, actual[1].first);
+    EXPECT_EQ(std::vector<std::string>{ "20231017120000123456789" }, actual[2].first);
+    EXPECT_EQ(2u, actual[2].second);
+}
@@ -0,0 +1,131 @@
+#include "pseudosem/table.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+TEST(VersionTable, rowsShouldCompareLikeVersions) {
+    std::vector<std::string> versions = {
+        "1.0", "1", "1.0.0.0", "1.0.1", "1.10", "1.9", "1.0a", "1.0-rc.1", "1.0-RC.2", "1.0-rc.1a",
+        "123456789012345678901234567890", "123456789012345678901234567891.0", "2.0+build", "", "0.0", "1.0-"
+    };
+    pseudosem::VersionTable table(versions);
+    ASSERT_EQ(versions.size(), table.size());
+
+    for (size_t i = 0; i < versions.size(); ++i) {
+        EXPECT_EQ(versions[i], table.str(i));
+        for (size_t j = 0; j < versions.size(); ++j) {
+            int expected = pseudosem::compare(versions[i], versions[j]);
+            int result = table.compare(i, j);
+            EXPECT_EQ(expected < 0, result < 0) << versions[i] << " vs " << versions[j];
+            EXPECT_EQ(expected > 0, result > 0) << versions[i] << " vs " << versions[j];
+            EXPECT_EQ(expected == 0, table.compare(i, pseudosem::Version(versions[j])) == 0);
+        }
+    }
+
+    EXPECT_TRUE(table.isPreRelease(7));
+    EXPECT_TRUE(table.isPreRelease(15));
+    EXPECT_FALSE(table.isPreRelease(6));
+}
+
+TEST(VersionTable, rowsShouldBeSortedAndSearched) {
+    std::mt19937 random(42);
+    std::vector<std::string> versions;
+    for (size_t i = 0; i < 10000; ++i) {
+        std::string ver = std::to_string(random() % 5) + "." + std::to_string(random() % 20);
+        if (random() % 4 == 0)
+            ver += "-beta." + std::to_string(random() % 3);
+        versions.push_back(ver);
+    }
+
+    pseudosem::VersionTable table;
+    table.append(versions.begin(), versions.begin() + 5000);
+    for (size_t i = 5000; i < versions.size(); ++i)
+        table.append(versions[i]);
+
+    std::vector<size_t> order(table.sortedOrder());
+    EXPECT_EQ(order, table.sortedOrder(4));
+    for (size_t i = 1; i < order.size(); ++i) {
+        int result = pseudosem::compare(versions[order[i - 1]], versions[order[i]]);
+        EXPECT_TRUE(result < 0 || (result == 0 && order[i - 1] < order[i]));
+    }
+
+    size_t latest = table.latest();
+    for (size_t i = 0; i < versions.size(); ++i)
+        EXPECT_GE(0, pseudosem::compare(versions[i], versions[latest]));
+    EXPECT_EQ(0, table.compare(latest, order.back()));
+
+    pseudosem::Version target("2.10");
+    size_t lower = table.lowerBound(order, target);
+    size_t upper = table.upperBound(order, target);
+    ASSERT_LT(lower, upper);
+    for (size_t i = lower; i < upper; ++i)
+        EXPECT_EQ(0, table.compare(order[i], target));
+    EXPECT_GT(0, table.compare(order[lower - 1], target));
+    EXPECT_LT(0, table.compare(order[upper], target));
+
+    size_t found = table.find(pseudosem::Version("2.10.0"));
+    ASSERT_LT(found, table.size());
+    EXPECT_EQ(order[lower], found);
+    EXPECT_EQ(table.size(), table.find(pseudosem::Version("9")));
+}
+
+TEST(VersionTable, anEmptyTableShouldHaveNoLatestRow) {
+    pseudosem::VersionTable table;
+    EXPECT_TRUE(table.empty());
+    EXPECT_EQ(0u, table.latest());
+    EXPECT_TRUE(table.sortedOrder().empty());
+}
+
+TEST(VersionTable, aVersionShouldBeComparedWithManyRows) {
+    std::vector<std::string> versions = {
+        "1.0", "1", "1.0.0.0", "1.0.0.1", "1.2.3", "1.2.3-rc.1", "1.2.3a", "1.2.4", "0.9", "1.10", "2", "",
+        "4294967295", "4294967296", "4294967296.1", "4294967296.0.2", "123456789012345678901234567890", "123456789012345678901234567890.2", "1.2.3.4-beta", "1.2-rc"
+    };
+    pseudosem::VersionTable table(versions);
+
+    for (const std::string& query : versions) {
+        std::vector<int> out(table.size());
+        pseudosem::compareMany(pseudosem::Version(query), table, out.data());
+
+        for (size_t i = 0; i < versions.size(); ++i) {
+            int expected = pseudosem::compare(query, versions[i]);
+            EXPECT_EQ(expected < 0, out[i] < 0) << query << " vs " << versions[i];
+            EXPECT_EQ(expected > 0, out[i] > 0) << query << " vs " << versions[i];
+        }
+    }
+}
+
+TEST(VersionTable, simdLeadNumberComparersShouldMatchTheScalarComparer) {
+    std::mt19937 random(3);
+    std::vector<uint32_t> columns[pseudosem::detail::leadNumberCount];
+    for (std::vector<uint32_t>& column : columns) {
+        for (size_t i = 0; i < 37; ++i)
+            column.push_back(random() % 3 == 0 ? 0xffffffff - random() % 2 : random() % 3);
+    }
+
+    const uint32_t* columnData[] = { columns[0].data(), columns[1].data(), columns[2].data() };
+    uint32_t versions[][pseudosem::detail::leadNumberCount] = { { 1, 1, 1 }, { 0, 2, 0 }, { 0xffffffff, 0xfffffffe, 2 } };
+
+    for (const uint32_t* version : versions) {
+        std::vector<int> expected(columns[0].size());
+        pseudosem::detail::compareLeadNumbersScalar(columnData, version, 0, expected.size(), expected.data());
+        std::vector<std::vector<int>> actual;
+
+#ifdef PSEUDOSEM_HAS_SSE2
+        actual.push_back(std::vector<int>(expected.size()));
+        pseudosem::detail::compareLeadNumbersSse2(columnData, version, 0, expected.size(), actual.back().data());
+#endif
+#ifdef PSEUDOSEM_HAS_AVX2
+        if (pseudosem::detail::hasAvx2()) {
+            actual.push_back(std::vector<int>(expected.size()));
+            pseudosem::detail::compareLeadNumbersAvx2(columnData, version, 0, expected.size(), actual.back().data());
+        }
+#endif
+
+        for (const std::vector<int>& results : actual)
+            EXPECT_EQ(expected, results);
+    }
+}
@@ -0,0 +1,333 @@
+// Sort lines of version strings by pseudosem precedence, like sort -V.
+
+#include "pseudosem/sort.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    const char* usage =
+        "Usage: pseudosem-sort [OPTION]... [FILE]\n"
+        "Write the lines of FILE, or standard input if FILE is - or not given, to\n"
+        "standard output sorted by pseudosem version precedence.\n"
+        "\n"
+        "  -u, --unique         output only the first of lines with equivalent versions\n"
+        "  -r, --reverse        output the latest versions first\n"
+        "  -n, --latest N       output only the N latest versions\n"
+        "  -k, --key N          sort by the Nth field of each line, counting from 1\n"
+        "  -t, --delimiter C    separate fields with C instead of a tab\n"
+        "  -j, --threads N      use N threads, instead of one per hardware thread\n"
+        "  -h, --help           display this help and exit\n";
+
+    struct Options {
+        Options() : unique(false), reverse(false), latest(0), hasLatest(false), key(0), delimiter('\t'), threads(0) {}
+
+        bool unique;
+        bool reverse;
+        size_t latest;
+        bool hasLatest;
+        size_t key;
+        char delimiter;
+        unsigned threads;
+        std::string path;
+    };
+
+    // The contents of a file, memory-mapped if possible.
+    class Input {
+    public:
+        explicit Input(const std::string& path) : contents(nullptr), length(0) {
+#ifdef _WIN32
+            file = INVALID_HANDLE_VALUE;
+            mapping = nullptr;
+#else
+            file = -1;
+#endif
+
+            if (path.empty() || path == "-") {
+                readAll(std::cin);
+                return;
+            }
+
+            // The destructor won't run if mapping fails, so release what
+            // was opened before rethrowing.
+            try {
+                map(path);
+            }
+            catch (...) {
+                release();
+                throw;
+            }
+        }
+
+        ~Input() {
+            release();
+        }
+
+        const char* data() const { return contents; }
+        size_t size() const { return length; }
+
+    private:
+        const char* contents;
+        size_t length;
+        std::string buffer;
+
+#ifdef _WIN32
+        HANDLE file;
+        HANDLE mapping;
+#else
+        int file;
+#endif
+
+        Input(const Input&) = delete;
+        Input& operator=(const Input&) = delete;
+
+        void map(const std::string& path) {
+#ifdef _WIN32
+            file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (file == INVALID_HANDLE_VALUE)
+                throw std::runtime_error("cannot open " + path);
+
+            LARGE_INTEGER size;
+            if (!GetFileSizeEx(file, &size))
+                throw std::runtime_error("cannot read " + path);
+
+            length = static_cast<size_t>(size.QuadPart);
+            if (length > 0) {
+                mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+                if (mapping == nullptr)
+                    throw std::runtime_error("cannot map " + path);
+
+                contents = static_cast<const char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+                if (contents == nullptr)
+                    throw std::runtime_error("cannot map " + path);
+            }
+#else
+            file = open(path.c_str(), O_RDONLY);
+            if (file < 0)
+                throw std::runtime_error("cannot open " + path);
+
+            struct stat status;
+            if (fstat(file, &status) != 0)
+                throw std::runtime_error("cannot read " + path);
+
+            length = static_cast<size_t>(status.st_size);
+            if (length > 0) {
+                void* address = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, file, 0);
+                if (address == MAP_FAILED)
+                    throw std::runtime_error("cannot map " + path);
+
+                contents = static_cast<const char*>(address);
+                madvise(address, length, MADV_SEQUENTIAL);
+            }
+#endif
+        }
+
+        // Unmap and close the file, if one was opened. Input read from a
+        // stream is freed with the buffer.
+        void release() {
+#ifdef _WIN32
+            if (file == INVALID_HANDLE_VALUE)
+                return;
+
+            if (contents != nullptr)
+                UnmapViewOfFile(contents);
+            if (mapping != nullptr)
+                CloseHandle(mapping);
+            CloseHandle(file);
+            file = INVALID_HANDLE_VALUE;
+#else
+            if (file < 0)
+                return;
+
+            if (contents != nullptr)
+                munmap(const_cast<char*>(contents), length);
+            close(file);
+            file = -1;
+#endif
+            contents = nullptr;
+        }
+
+        void readAll(std::istream& in) {
+            char chunk[65536];
+            while (in.read(chunk, sizeof(chunk)) || in.gcount() > 0)
+                buffer.append(chunk, static_cast<size_t>(in.gcount()));
+
+            contents = buffer.data();
+            length = buffer.size();
+        }
+    };
+
+    struct Line {
+        const char* data;
+        size_t size;
+        pseudosem::detail::Token key;
+    };
+
+    size_t parseCount(const std::string& option, const char* value) {
+        char* end = nullptr;
+        unsigned long count = std::strtoul(value, &end, 10);
+        if (*value == '\0' || *end != '\0')
+            throw std::invalid_argument("invalid number for " + option + ": " + value);
+
+        return count;
+    }
+
+    Options parseOptions(int argc, char** argv) {
+        Options options;
+
+        for (int i = 1; i < argc; ++i) {
+            std::string arg(argv[i]);
+            bool hasValue = i + 1 < argc;
+
+            if (arg == "-h" || arg == "--help") {
+                std::cout << usage;
+                std::exit(0);
+            }
+            else if (arg == "-u" || arg == "--unique")
+                options.unique = true;
+            else if (arg == "-r" || arg == "--reverse")
+                options.reverse = true;
+            else if ((arg == "-n" || arg == "--latest") && hasValue) {
+                options.latest = parseCount(arg, argv[++i]);
+                options.hasLatest = true;
+            }
+            else if ((arg == "-k" || arg == "--key") && hasValue) {
+                options.key = parseCount(arg, argv[++i]);
+                if (options.key == 0)
+                    throw std::invalid_argument("fields are counted from 1");
+            }
+            else if ((arg == "-t" || arg == "--delimiter") && hasValue) {
+                std::string delimiter(argv[++i]);
+                if (delimiter.size() != 1)
+                    throw std::invalid_argument("the delimiter must be a single character");
+
+                options.delimiter = delimiter[0];
+            }
+            else if ((arg == "-j" || arg == "--threads") && hasValue)
+                options.threads = static_cast<unsigned>(parseCount(arg, argv[++i]));
+            else if ((arg.empty() || arg[0] != '-' || arg == "-") && options.path.empty())
+                options.path = arg;
+            else
+                throw std::invalid_argument("unrecognised argument: " + arg);
+        }
+
+        return options;
+    }
+
+    // Split the input into lines, without copying them.
+    std::vector<Line> splitLines(const char* data, size_t size, const Options& options) {
+        std::vector<Line> lines;
+        const char* end = data + size;
+
+        while (data != end) {
+            const char* lineEnd = std::find(data, end, '\n');
+
+            Line line;
+            line.data = data;
+            line.size = lineEnd - data;
+
+            const char* keyStart = data;
+            const char* keyEnd = lineEnd;
+            if (keyEnd != keyStart && keyEnd[-1] == '\r')
+                --keyEnd;
+
+            if (options.key > 0) {
+                for (size_t field = 1; field < options.key && keyStart != keyEnd; ++field) {
+                    keyStart = std::find(keyStart, keyEnd, options.delimiter);
+                    if (keyStart != keyEnd)
+                        ++keyStart;
+                }
+
+                keyEnd = std::find(keyStart, keyEnd, options.delimiter);
+            }
+
+            line.key.data = keyStart;
+            line.key.size = keyEnd - keyStart;
+            lines.push_back(line);
+
+            data = lineEnd == end ? end : lineEnd + 1;
+        }
+
+        return lines;
+    }
+
+    void run(const Options& options) {
+        Input input(options.path);
+        std::vector<Line> lines(splitLines(input.data(), input.size(), options));
+
+        size_t count = lines.size();
+        std::vector<pseudosem::detail::VersionParts> parts(count);
+        size_t threads = pseudosem::detail::threadCount(options.threads, count, 1024);
+        pseudosem::detail::parallelFor(threads, [&](size_t i) {
+            for (size_t j = i * count / threads; j < (i + 1) * count / threads; ++j)
+                parts[j] = pseudosem::detail::VersionParts(lines[j].key.data, lines[j].key.size);
+        });
+
+        std::vector<size_t> order(pseudosem::detail::sortedOrder(parts, pseudosem::detail::threadCount(options.threads, count, 4096)));
+
+        if (options.unique) {
+            auto equivalent = [&parts](size_t a, size_t b) {
+                return parts[a].compare(parts[b]) == 0;
+            };
+            order.erase(std::unique(order.begin(), order.end(), equivalent), order.end());
+        }
+
+        if (options.hasLatest && options.latest < order.size())
+            order.erase(order.begin(), order.end() - options.latest);
+
+        if (options.reverse) {
+            // Reverse the order of versions, but keep lines with equivalent
+            // versions in their input order.
+            std::vector<size_t> reversed;
+            reversed.reserve(order.size());
+
+            size_t groupEnd = order.size();
+            while (groupEnd > 0) {
+                size_t groupStart = groupEnd - 1;
+                while (groupStart > 0 && parts[order[groupStart - 1]].compare(parts[order[groupEnd - 1]]) == 0)
+                    --groupStart;
+
+                reversed.insert(reversed.end(), order.begin() + groupStart, order.begin() + groupEnd);
+                groupEnd = groupStart;
+            }
+
+            order.swap(reversed);
+        }
+
+        static char outputBuffer[1 << 16];
+        std::setvbuf(stdout, outputBuffer, _IOFBF, sizeof(outputBuffer));
+
+        for (size_t index : order) {
+            std::fwrite(lines[index].data, 1, lines[index].size, stdout);
+            std::fputc('\n', stdout);
+        }
+
+        std::fflush(stdout);
+    }
+}
+
+int main(int argc, char** argv) {
+    try {
+        run(parseOptions(argc, argv));
+    }
+    catch (std::exception& e) {
+        std::cerr << "pseudosem-sort: " << e.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}